@@ -0,0 +1,59 @@
+#ifndef BALLSWARM_H
+#define BALLSWARM_H
+
+#include <vector>
+#include <cstdint>
+
+#include <SFML/Graphics.hpp>
+
+//////////////////////////////////////////////////////////
+/////// BALL SWARM
+// Extra balls (multi-ball power-up, stress tests) kept as structure of
+// arrays : x, y, vx, vy side by side so integration, wall bounces and the
+// broad phase run on four balls per SSE2 instruction (scalar loops when
+// the compiler doesn't target SSE2). Velocities are
+// stored as vectors, no cos/sin per frame. One vertex array draws them all.
+struct SwarmGrid
+{
+    sf::Vector2f        origin;
+    float               cellW, cellH;
+    std::size_t         rows, cols;
+    const std::uint8_t *alive;     // rows * cols, 1 : block there
+};
+
+class BallSwarm : public sf::Drawable
+{
+public:
+    BallSwarm(float radius, const sf::FloatRect& bounds);
+
+    void spawn(const sf::Vector2f& position, float speed, float angleMinDeg, float angleMaxDeg, std::size_t count);
+    void clear();
+
+    // Moves every ball, bounces on the bounds, the paddle and alive cells.
+    // Cells hit are pushed in 'hits' (row * cols + col), once per ball impact.
+    void update(float dt, const SwarmGrid& grid, const sf::FloatRect& paddle, std::vector<std::size_t>& hits);
+
+    inline std::size_t size() const { return m_x.size(); }
+    // Balls simulated per millisecond over the last update
+    inline double getBallsPerMs() const { return m_ballsPerMs; }
+
+private:
+    float              m_radius;
+    sf::FloatRect      m_bounds;
+    std::vector<float> m_x, m_y, m_vx, m_vy;
+    float              m_maxSpeed;
+    double             m_ballsPerMs;
+
+    // Render
+    sf::Texture        m_texture;
+    sf::VertexArray    m_vertices;
+
+    void integrate(float dt);
+    void collidePaddle(const sf::FloatRect& paddle);
+    void collideGrid(const SwarmGrid& grid, std::vector<std::size_t>& hits);
+    void updateVertices();
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+};
+
+#endif // BALLSWARM_H
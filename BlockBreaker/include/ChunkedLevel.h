@@ -0,0 +1,131 @@
+#ifndef CHUNKEDLEVEL_H
+#define CHUNKEDLEVEL_H
+
+#include <string>
+#include <vector>
+#include <future>
+#include <cstdint>
+
+#include <SFML/Graphics.hpp>
+
+#include "LevelPack.h"
+
+//////////////////////////////////////////////////////////
+/////// CHUNKED LEVEL
+// Level of any height cut in chunks of CHUNK_ROWS rows. Only the chunks
+// around the camera are live (cells + one vertex array each) : they are
+// the only ones hit, updated and drawn. The others stay run-length encoded,
+// and a chunk with no block left frees everything. Per frame work depends
+// on the screen size, not on the level size. The next level of a pack is
+// decoded, cut and encoded on a background thread while this one plays.
+const std::size_t CHUNK_ROWS = 16;
+
+class ChunkedLevel : public sf::Drawable
+{
+public:
+    ChunkedLevel(const sf::Vector2f& blockSize, const sf::Vector2f& viewSize);
+
+    // Columns that don't fit in the view width are cropped
+    void load(const Level& level, const sf::Texture *texture);
+
+    ////////// NEXT LEVEL (the pack must outlive a prefetch still running)
+    void prefetch(const LevelPack& pack, std::size_t index);
+    // Prefetched level if it's that one (waits if still running), else
+    // built now. False if the level doesn't decode.
+    bool take(const LevelPack& pack, std::size_t index, const std::vector<sf::Texture>& textures);
+    inline const std::string& getName() const { return m_name; }
+
+    ////////// CAMERA
+    // World y shown at the top of the screen (chunks follow on update())
+    inline void setCamera(float top) { m_camera = top; }
+    inline float getCamera() const { return m_camera; }
+    inline float getHeight() const { return m_rows * m_blockSize.y; }
+    // Once per step : makes the chunks around the camera live, evicts the
+    // far ones and applies the damages of the step to the vertex arrays
+    void update();
+
+    ////////// CELLS (rows from the top of the level)
+    inline std::size_t rows() const { return m_rows; }
+    inline std::size_t cols() const { return m_cols; }
+    inline const sf::Vector2f& getBlockSize() const { return m_blockSize; }
+    inline const sf::Texture* getTexture() const { return m_texture; }
+    // Screen position of cell (0, 0)
+    inline sf::Vector2f getOrigin() const { return sf::Vector2f{m_left, -m_camera}; }
+    // Rows that can be on screen, all of them live
+    std::size_t firstVisibleRow() const;
+    std::size_t visibleRows() const;
+
+    // False outside the live chunks
+    bool isAlive(std::size_t row, std::size_t col) const;
+    sf::FloatRect getBounds(std::size_t row, std::size_t col) const;
+    // True if that hit broke the block
+    bool takeDamage(std::size_t row, std::size_t col);
+
+    inline std::size_t breakableLeft() const { return m_breakable; }
+    // Screen y under the lowest breakable block of the live chunks,
+    // lowest float if there is none
+    float lowestBreakable() const;
+
+    ////////// STATS
+    inline std::size_t chunkCount() const { return m_chunks.size(); }
+    inline std::size_t liveChunks() const { return m_liveCount; }
+    inline std::size_t clearedChunks() const { return m_clearedCount; }
+
+private:
+    enum chunkState{COMPACT, LIVE, CLEARED};
+
+    struct Chunk
+    {
+        chunkState                state{COMPACT};
+        std::vector<std::uint8_t> runs;                   // COMPACT
+        Matrix<LevelCell>         cells;                  // LIVE
+        sf::VertexArray           vertices{sf::Quads};    // LIVE, alive blocks
+        std::size_t               solid{0};               // alive blocks, unbreakable too
+        std::size_t               breakable{0};
+        std::size_t               lowest{0};              // 1 + lowest row with a breakable block, 0 : none
+        bool                      dirty{false};
+    };
+
+    // A level cut in chunks, every chunk compact or cleared : built on
+    // any thread, swapped in by the game thread
+    struct Layout
+    {
+        std::string         name;
+        std::uint8_t        texture{0};
+        std::vector<Chunk>  chunks;
+        std::size_t         rows{0}, cols{0};
+        std::size_t         breakable{0};
+        std::size_t         cleared{0};
+        bool                valid{false};
+    };
+
+    sf::Vector2f        m_blockSize;
+    sf::Vector2f        m_viewSize;
+    const sf::Texture  *m_texture;
+    std::vector<Chunk>  m_chunks;
+    std::size_t         m_rows, m_cols;
+    float               m_left;
+    float               m_camera;
+    std::size_t         m_liveBegin, m_liveEnd;   // chunks that may be live
+    std::size_t         m_liveCount, m_clearedCount;
+    std::size_t         m_breakable;
+    std::string         m_name;
+
+    std::future<Layout> m_next;
+    std::size_t         m_nextIndex;
+
+    static Layout cut(const Level& level, std::size_t maxCols);
+    void install(Layout& layout, const sf::Texture *texture);
+    std::size_t maxCols() const;
+
+    std::size_t chunkRows(std::size_t chunk) const;
+    std::size_t chunkAt(float y) const;
+    void activate(Chunk& chunk, std::size_t index);
+    void evict(Chunk& chunk);
+    void release(Chunk& chunk);
+    void rebuild(Chunk& chunk, std::size_t index);
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+};
+
+#endif // CHUNKEDLEVEL_H
@@ -0,0 +1,43 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <SFML/Graphics.hpp>
+
+#include "ParticlePool.h"
+
+//////////////////////////////////////////////////////////
+/////// EFFECTS
+// Block hits and breaks : debris cut from the block texture, sparks, and
+// a "+points" pop-up. Debris use the level texture ; sparks and pop-ups
+// use a small texture made here (a disc and the digits). Two pools, so
+// two draw calls whatever the number of particles.
+class Effects : public sf::Drawable
+{
+public:
+    Effects(std::size_t debrisCapacity, std::size_t fxCapacity);
+
+    inline void setBlockTexture(const sf::Texture *texture) { m_debris.setTexture(texture); }
+
+    void blockHit(const sf::FloatRect& block);
+    void blockBroken(const sf::FloatRect& block, unsigned points);
+    void update(float dt);
+    void clear();
+
+    ////////// STATS (both pools)
+    std::size_t size() const { return m_debris.size() + m_fx.size(); }
+    std::size_t capacity() const { return m_debris.capacity() + m_fx.capacity(); }
+    std::size_t getDropped() const { return m_debris.getDropped() + m_fx.getDropped(); }
+    double getUpdateTime() const { return m_debris.getUpdateTime() + m_fx.getUpdateTime(); }
+    double getDrawTime() const { return m_debris.getDrawTime() + m_fx.getDrawTime(); }
+
+private:
+    sf::Texture  m_fxTexture;
+    ParticlePool m_debris;
+    ParticlePool m_fx;
+
+    void sparks(const sf::Vector2f& center, unsigned count);
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+};
+
+#endif // EFFECTS_H
@@ -0,0 +1,90 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <cstdint>
+
+#include "../../Utilities/Matrix.hpp"
+#include "../../Utilities/MappedFile.hpp"
+
+//////////////////////////////////////////////////////////
+/////// LEVEL PACK
+// Many levels in one file, mapped and decoded one level at a time
+// (decode() may run on any thread).
+// File (little-endian) :
+//   "BBLP", version u8, texture count u8, level count u16
+//   textures : length u8 + path, for each
+//   index    : offset u32 + size u32 (from file start), for each level
+//   level    : rows u16, cols u16, texture u8, name length u8 + name,
+//              then (run u8, cell u8) pairs, row-major
+// A cell is (type << 4) | hit points ; 0 is no block.
+enum blockType{
+    EMPTY,
+    NORMAL,
+    HARD,
+    UNBREAKABLE,
+    BLOCK_TYPE_MAX
+};
+
+struct LevelCell
+{
+    std::uint8_t type{blockType::EMPTY};
+    std::uint8_t hp{0};
+};
+
+struct Level
+{
+    std::string       name;
+    std::uint8_t      texture{0};     // index in the pack's texture table
+    Matrix<LevelCell> cells;
+};
+
+class LevelPack
+{
+public:
+    LevelPack();
+
+    LevelPack(const LevelPack&) = delete;
+    LevelPack& operator=(const LevelPack&) = delete;
+
+    // Reads the header and index only, levels are decoded on demand
+    bool open(const std::string& fileName);
+    bool decode(std::size_t index, Level& level) const;
+
+    inline std::size_t count() const { return m_index.size(); }
+    inline const std::vector<std::string>& getTextures() const { return m_textures; }
+    inline bool isMapped() const { return m_file.isMapped(); }
+    inline const std::string& getError() const { return m_error; }
+
+    ////////// SOURCES / TOOL SIDE
+    // Text levels : see levels/levels.txt for the syntax
+    static bool parseText(std::istream& is, std::vector<Level>& levels,
+                          std::vector<std::string>& textures, std::string& error);
+    static bool write(const std::string& fileName, const std::vector<Level>& levels,
+                      const std::vector<std::string>& textures);
+
+    ////////// CELLS
+    static std::uint8_t packCell(const LevelCell& cell);
+    static LevelCell unpackCell(std::uint8_t value);
+    // (run u8, cell u8) pairs, as stored in the pack
+    static void encodeRuns(const LevelCell *cells, std::size_t count, std::vector<std::uint8_t>& out);
+    // Returns the number of cells written (count if the runs were complete)
+    static std::size_t decodeRuns(const std::uint8_t *first, const std::uint8_t *last,
+                                  LevelCell *cells, std::size_t count);
+
+private:
+    struct Entry
+    {
+        std::uint32_t offset;
+        std::uint32_t size;
+    };
+
+    MappedFile               m_file;
+    std::vector<std::string> m_textures;
+    std::vector<Entry>       m_index;
+    std::string              m_error;
+};
+
+#endif // LEVELPACK_H
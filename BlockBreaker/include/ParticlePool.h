@@ -0,0 +1,56 @@
+#ifndef PARTICLEPOOL_H
+#define PARTICLEPOOL_H
+
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+//////////////////////////////////////////////////////////
+/////// PARTICLE POOL
+// Fixed number of particles sharing one texture. Every array is sized in
+// the constructor and never grows : a dead particle takes the place of the
+// last live one, so the live ones stay packed at the front and emitting
+// never allocates. Update runs one loop per field, the quads of all
+// particles go in a single draw call.
+class ParticlePool : public sf::Drawable
+{
+public:
+    ParticlePool(std::size_t capacity, const sf::Texture *texture = nullptr);
+
+    // False when the pool is full : the particle is dropped
+    bool emit(const sf::Vector2f& position, const sf::Vector2f& velocity, const sf::Vector2f& size,
+              const sf::FloatRect& texRect, const sf::Color& color, float life, float gravity = 0.f);
+    void update(float dt);
+    void clear();
+
+    inline void setTexture(const sf::Texture *texture) { m_texture = texture; }
+
+    inline std::size_t size() const { return m_count; }
+    inline std::size_t capacity() const { return m_life.size(); }
+    inline std::size_t getDropped() const { return m_dropped; }
+    // Last update / draw, in ms
+    inline double getUpdateTime() const { return m_updateMs; }
+    inline double getDrawTime() const { return m_drawMs; }
+
+private:
+    const sf::Texture *m_texture;
+    std::size_t        m_count;
+    std::size_t        m_dropped;
+
+    std::vector<float>     m_x, m_y, m_vx, m_vy;
+    std::vector<float>     m_w, m_h, m_gravity;
+    std::vector<float>     m_life, m_invMaxLife;
+    std::vector<float>     m_u, m_v, m_texW, m_texH;
+    std::vector<sf::Color> m_color;
+    std::vector<sf::Vertex> m_vertices;      // 4 per particle, first m_count * 4 drawn
+
+    double         m_updateMs;
+    mutable double m_drawMs;
+
+    void kill(std::size_t i);
+    void updateVertices();
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+};
+
+#endif // PARTICLEPOOL_H
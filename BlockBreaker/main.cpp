@@ -1,8 +1,19 @@
-#include "include/Outils.h"
-#include "../../Utilities/Matrix.hpp"
+#include "include/BallSwarm.h"
+#include "include/LevelPack.h"
+#include "include/ChunkedLevel.h"
+#include "include/Effects.h"
+#include "../Utilities/Matrix.hpp"
+#include "../Utilities/Collision.hpp"
+#include "../Utilities/Random.hpp"
+#include "../Utilities/GameLoop.hpp"
+#define ASSETLOADER_NO_AUDIO
+#include "../Utilities/AssetLoader.hpp"
 
 #include <iostream>
+#include <string>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include <SFML/Graphics.hpp>
 
 /// ///////////////////////////////////////////////
@@ -20,8 +31,14 @@ const float           PAD_Y = WINDOW_H - (PAD_H + 10.f);
 const float        SPEEDPAD = 250.f;
 const float       SPEEDBALL = 150.f;
 const float              PI = 3.141592f;
-
-const sf::Vector2f origin_grid{(WINDOW_W - (GRID_COLS*BLOCK_W)) / 2.f, 0.f};
+const float    SWARM_RADIUS = 4.f;
+const std::size_t SWARM_STRESS = 10000;
+// Tall levels scroll down while their lowest block is above this line
+const float    SCROLL_LIMIT = WINDOW_H / 2.f;
+const float    SCROLL_SPEED = 30.f;
+const unsigned BLOCK_POINTS = 10;
+const std::size_t PARTICLES_DEBRIS = 16384;
+const std::size_t PARTICLES_FX     = 32768;
 
 /// ///////////////////////////////////////////////
 /// ENUMS
@@ -30,13 +47,29 @@ std::vector<bool> key(KEY_MAX, false);
 
 /// ///////////////////////////////////////////////
 /// PROTO(S)
-class Block;
 class Ball;
 class Paddle;
-Block createBlock(float, float, sf::Texture*);
-bool collideWithPaddle(const Ball&, const Paddle&);
-bool collideWithBlock(const Ball&, const Block&);
-sf::Vector2f sizeRectFromPoints(const sf::Vector2f&, const sf::Vector2f&);
+
+/// ///////////////////////////////////////////////
+/// BROAD PHASE
+// Blocks sit on a uniform grid, so the cells a ball can touch during a
+// frame are read from its swept bounds instead of testing every block.
+// Rows are level rows (the camera is in the grid origin).
+struct CellRange
+{
+    std::size_t rowMin, rowMax;   // inclusive
+    std::size_t colMin, colMax;
+    bool        empty;
+};
+sf::FloatRect sweptBounds(const sf::FloatRect&, const sf::FloatRect&);
+CellRange cellsTouched(const sf::FloatRect&, const ChunkedLevel&);
+
+/// ///////////////////////////////////////////////
+/// NARROW PHASE (swept circle, see Utilities/Collision.hpp)
+// Contact ids : blocks are (row * cols) + col, the paddle is last
+const std::size_t PADDLE_ID = std::numeric_limits<std::size_t>::max();
+Collision::Contact firstContact(const sf::Vector2f&, float, const sf::Vector2f&,
+                                const ChunkedLevel&, const Paddle&, unsigned&);
 
 /// ///////////////////////////////////////////////
 /// CLASS PADDLE
@@ -62,62 +95,6 @@ void Paddle::move(const sf::Time& dt, int dir)
             break;
     }
 }
-/// ///////////////////////////////////////////////
-/// CLASS BLOCK
-class Block : public sf::RectangleShape
-{
-public:
-    Block();
-    Block(const sf::Vector2f&);
-    Block(const sf::Vector2f&, sf::Texture*, bool alive = true);
-    ~Block() {}
-
-    void takeDamage();
-    bool isAlive() const { return m_isAlive; }
-
-private:
-    sf::Texture *m_texture = nullptr;
-    bool         m_isAlive = true;
-    int             m_life = 3;
-};
-//////////////////////
-Block::Block() :
-    sf::RectangleShape{}
-{
-
-}
-
-Block::Block(const sf::Vector2f& size) :
-    sf::RectangleShape{size}
-{
-
-}
-
-Block::Block(const sf::Vector2f& size, sf::Texture* blk_texture, bool alive) :
-    sf::RectangleShape{size}, m_texture{blk_texture}, m_isAlive{alive}
-{
-    setTexture(blk_texture);
-    setTextureRect(sf::IntRect{120, 0, 60, 24});
-
-    if(!m_isAlive){
-        m_life = 0;
-        setFillColor(sf::Color::Transparent);
-    }
-}
-
-void Block::takeDamage()
-{
-    if(m_life != 0){
-        --m_life;
-        setTextureRect(sf::IntRect{60 * (m_life - 1), 0, 60, 24});
-    }
-
-    if(m_life == 0 && m_isAlive){
-        m_isAlive = false;
-        setFillColor(sf::Color::Transparent);
-    }
-}
-
 /// ///////////////////////////////////////////////
 /// CLASS BALL
 class Ball : public sf::CircleShape
@@ -126,15 +103,13 @@ public:
     Ball() = delete;
     Ball(float radius=0, std::size_t pointCount=30);
 
-    void move(const sf::Time&);
+    sf::Vector2f getVelocity() const;
+    void setVelocity(const sf::Vector2f&);
     void bounce(const Paddle&);
-    void bounce(const Block&);
     sf::FloatRect getGlobalBounds() const;
 
 private:
 
-    float distFromMidW(const Block&) const;
-    float distFromMidH(const Block&) const;
     void startRotation();
 
     friend std::ostream& operator<<(std::ostream& os, const Ball& b){
@@ -153,29 +128,22 @@ Ball::Ball(float radius, std::size_t pointCount) :
     startRotation();
 }
 
-void Ball::move(const sf::Time& dt)
+sf::Vector2f Ball::getVelocity() const
 {
-    const float angle_deg{getRotation()};
-    const float angle_rad{(PI * angle_deg) / 180.f};
-
-    sf::CircleShape::move(cos(angle_rad) * SPEEDBALL * dt.asSeconds(),
-                          sin(angle_rad) * SPEEDBALL * dt.asSeconds());
-}
+    const float angle_rad{(PI * getRotation()) / 180.f};
 
-float Ball::distFromMidW(const Block& block) const
-{
-    return (getPosition().x - (block.getPosition().x + (block.getGlobalBounds().width/2.f)));
+    return sf::Vector2f{std::cos(angle_rad) * SPEEDBALL, std::sin(angle_rad) * SPEEDBALL};
 }
 
-float Ball::distFromMidH(const Block& block) const
+void Ball::setVelocity(const sf::Vector2f& velocity)
 {
-    return (getPosition().y - (block.getPosition().y + (block.getGlobalBounds().height/2.f)));
+    setRotation(std::atan2(velocity.y, velocity.x) * 180.f / PI);
 }
 
 void Ball::startRotation()
 {
     std::array<float, 4> tmp{250.f, 265.f, 275.f, 290.f};
-    setRotation(tmp[static_cast<std::size_t>(Outils::rollTheDice(0, tmp.size()))]);
+    setRotation(tmp[Random::local().below(static_cast<std::uint32_t>(tmp.size()))]);
 }
 
 void Ball::bounce(const Paddle& p)
@@ -203,227 +171,102 @@ sf::FloatRect Ball::getGlobalBounds() const
                          {sf::CircleShape::getGlobalBounds().width, sf::CircleShape::getGlobalBounds().height}};
 }
 
-void Ball::bounce(const Block& block)
+/// ///////////////////////////////////////////////
+/// OTHER FUNCTION(S)
+// Union of the ball bounds before and after its move
+sf::FloatRect sweptBounds(const sf::FloatRect& before, const sf::FloatRect& after)
 {
-    const float angle{getRotation()};
-    const float bounce_horizontally{360.f - angle};
-    float bounce_vertically{180.f - angle};
-
-    if(bounce_vertically < 0.f)
-        bounce_vertically = 360.f - (bounce_vertically * -1.f);
-
-    /// TOP
-    if(getGlobalBounds().top <= block.getPosition().y &&
-       getGlobalBounds().top + getGlobalBounds().height >= block.getPosition().y)
-    {
-        // Top-Left
-        if(getGlobalBounds().left <= block.getPosition().x &&
-           getGlobalBounds().left + getGlobalBounds().width >= block.getPosition().x)
-        {
-            if(angle > 0.f && angle < 90.f){
-
-                const sf::Vector2f diffFromCorner{
-                    sizeRectFromPoints(sf::Vector2f(block.getPosition()),
-                                       sf::Vector2f(getGlobalBounds().left + getGlobalBounds().width, getGlobalBounds().top + getGlobalBounds().height))
-                };
-
-                if(diffFromCorner.x < diffFromCorner.y){
-                    // Bounce left
-                    setRotation(bounce_vertically);
-                }
-                else if(diffFromCorner.x > diffFromCorner.y){
-                    // Bounce top
-                    setRotation(bounce_horizontally);
-                }
-                else{
-                    setRotation(225.f);
-                }
-            }
-            else if(angle > 90.f && angle < 180.f){
-                // Bounce Top
-                setRotation(bounce_horizontally);
-            }
-            else if(angle > 270 && angle < 360){
-                // Bounce Left
-                setRotation(bounce_vertically);
-            }
-        }
-        // Top Right
-        else if(getGlobalBounds().left <= block.getPosition().x + block.getGlobalBounds().width &&
-                getGlobalBounds().left + getGlobalBounds().width >= block.getPosition().x + block.getGlobalBounds().width)
-        {
-            if(angle > 90.f && angle < 180.f){
+    const float left{std::min(before.left, after.left)};
+    const float top{std::min(before.top, after.top)};
+    const float right{std::max(before.left + before.width, after.left + after.width)};
+    const float bottom{std::max(before.top + before.height, after.top + after.height)};
 
-                const sf::Vector2f diffFromCorner{
-                    sizeRectFromPoints(sf::Vector2f(getGlobalBounds().left, getGlobalBounds().top + getGlobalBounds().height),
-                                       sf::Vector2f(block.getPosition().x + block.getGlobalBounds().width, block.getPosition().y))
-                };
-
-                if(diffFromCorner.x < diffFromCorner.y){
-                    // Bounce Right
-                    setRotation(bounce_vertically);
-                }
-                else if(diffFromCorner.x > diffFromCorner.y){
-                    // Bounce top
-                    setRotation(bounce_horizontally);
-                }
-                else{
-                    setRotation(320.f);
-                }
-            }
-            else if(angle > 0.f && angle < 90.f){
-                //Bounce Top
-                setRotation(bounce_horizontally);
-            }
-            else if(angle > 180.f && angle < 270.f){
-                // Bounce Right
-                setRotation(bounce_vertically);
-            }
-        }
-        // Middle
-        else
-        {
-            // Bounce Top
-            if(angle > 0.f && angle < 90.f){
-                setRotation(bounce_horizontally);
-            }
-            if(angle > 90.f && angle < 180.f){
-                setRotation(bounce_horizontally);
-            }
-        }
-    }
-
-    /// BOTTOM
-    if(getGlobalBounds().top <= block.getPosition().y + block.getGlobalBounds().height &&
-       getGlobalBounds().top + getGlobalBounds().height >= block.getPosition().y + block.getGlobalBounds().height)
-    {
-        // Bottom Left
-        if(getGlobalBounds().left <= block.getPosition().x &&
-           getGlobalBounds().left + getGlobalBounds().width >= block.getPosition().x)
-        {
-            if(angle > 270.f && angle < 360.f){
-
-                const sf::Vector2f diffFromCorner{
-                    sizeRectFromPoints(sf::Vector2f(block.getPosition().x, block.getPosition().y + block.getGlobalBounds().height),
-                                       sf::Vector2f(getGlobalBounds().left + getGlobalBounds().width, getGlobalBounds().top))
-                };
-
-                if(diffFromCorner.x < diffFromCorner.y){
-                    // Bounce Left
-                    setRotation(bounce_vertically);
-                }
-                else if(diffFromCorner.x > diffFromCorner.y){
-                    // Bounce Bottom
-                    setRotation(bounce_horizontally);
-                }
-                else{
-                    setRotation(135.f);
-                }
-            }
-            else if(angle > 0.f && angle < 90.f){
-                // Bounce Left
-                setRotation(bounce_vertically);
-            }
-            else if(angle > 180.f && angle < 270.f){
-                // Bounce Bottom
-                setRotation(bounce_horizontally);
-            }
-        }
-        // Bottom Right
-        else if(getGlobalBounds().left <= block.getPosition().x + block.getGlobalBounds().width &&
-                getGlobalBounds().left + getGlobalBounds().width >= block.getPosition().x + block.getGlobalBounds().width)
-        {
-            if(angle > 180.f && angle < 270.f){
-
-                const sf::Vector2f diffFromCorner{
-                    sizeRectFromPoints(sf::Vector2f(getGlobalBounds().left, getGlobalBounds().top),
-                                       sf::Vector2f(block.getPosition() + block.getSize()))
-                };
+    return sf::FloatRect{left, top, right - left, bottom - top};
+}
+// Grid cells overlapped by 'area' (clamped to the grid)
+CellRange cellsTouched(const sf::FloatRect& area, const ChunkedLevel& level)
+{
+    const sf::Vector2f origin{level.getOrigin()};
+    const sf::Vector2f block{level.getBlockSize()};
+    const float gridW{level.cols() * block.x};
+    const float gridH{level.rows() * block.y};
+    const float left{area.left - origin.x};
+    const float top{area.top - origin.y};
+
+    if(level.rows() == 0 || left + area.width < 0.f || left > gridW || top + area.height < 0.f || top > gridH)
+        return CellRange{0, 0, 0, 0, true};
+
+    auto cell = [](float v, float size, std::size_t count){
+        const float c{std::floor(v / size)};
+        return static_cast<std::size_t>(std::min(std::max(c, 0.f), static_cast<float>(count - 1)));
+    };
+
+    return CellRange{cell(top, block.y, level.rows()), cell(top + area.height, block.y, level.rows()),
+                     cell(left, block.x, level.cols()), cell(left + area.width, block.x, level.cols()),
+                     false};
+}
 
-                if(diffFromCorner.x < diffFromCorner.y){
-                    // Bounce Right
-                    setRotation(bounce_vertically);
-                }
-                else if(diffFromCorner.x > diffFromCorner.y){
-                    // Bounce Bottom
-                    setRotation(bounce_horizontally);
-                }
-                else{
-                    setRotation(45.f);
-                }
-            }
-            else if(angle > 270.f && angle < 360.f){
-                // Bounce Bottom
-                setRotation(bounce_horizontally);
-            }
-            else if(angle > 90.f && angle < 180.f){
-                // Bounce Right
-                setRotation(bounce_vertically);
-            }
+// Earliest block or paddle the ball meets on its way from 'from' by 'delta'
+Collision::Contact firstContact(const sf::Vector2f& from, float radius, const sf::Vector2f& delta,
+                                const ChunkedLevel& level, const Paddle& pad, unsigned& tests)
+{
+    Collision::Contact first;
+
+    auto consider = [&](const sf::FloatRect& box, std::size_t id){
+        ++tests;
+        const Collision::Hit hit{Collision::sweepCircleRect(from, radius, delta, box)};
+        if(hit.hit && hit.time < first.hit.time){
+            first.hit = hit;
+            first.id  = id;
         }
-        // Middle
-        else
-        {
-            // Bounce Bottom
-            if(angle > 270.f && angle < 360.f){
-                setRotation(bounce_horizontally);
-            }
-
-            if(angle > 180.f && angle < 270.f){
-                setRotation(bounce_horizontally);
+    };
+
+    // Broad phase : only the cells under the swept ball
+    const sf::FloatRect before{from.x - radius, from.y - radius, radius*2.f, radius*2.f};
+    const sf::FloatRect after{before.left + delta.x, before.top + delta.y, before.width, before.height};
+    const CellRange cells{cellsTouched(sweptBounds(before, after), level)};
+    if(!cells.empty){
+        for(std::size_t i=cells.rowMin; i<=cells.rowMax; ++i){
+            for(std::size_t j=cells.colMin; j<=cells.colMax; ++j){
+                if(level.isAlive(i, j))
+                    consider(level.getBounds(i, j), (i*level.cols())+j);
             }
         }
     }
 
-    /// MIDDLE
-    if(getGlobalBounds().top >= block.getPosition().y &&
-       getGlobalBounds().top + getGlobalBounds().height <= block.getPosition().y + block.getGlobalBounds().height)
-    {
-        // Left ?
-
-        // Right ?
-    }
-}
-/// ///////////////////////////////////////////////
-/// OTHER FUNCTION(S)
-// Collide With Paddle
-bool collideWithPaddle(const Ball& b, const Paddle& p)
-{
-    if((b.getPosition().x + b.getRadius()) >= p.getPosition().x &&
-       (b.getPosition().x - b.getRadius()) <= p.getPosition().x + PAD_W)
-    {
-        if((b.getPosition().y + b.getRadius()) >= p.getPosition().y &&
-           (b.getPosition().y - b.getRadius()) <= p.getPosition().y)
-        {
-            return true;
-        }
-
-        return false;
-    }
-
-    return false;
-}
-// Collide With Block
-bool collideWithBlock(const Ball& ball, const Block& block)
-{
-    sf::FloatRect ballBounds{ball.getGlobalBounds().left,
-                             ball.getGlobalBounds().top,
-                             ball.getRadius()*2.f, ball.getRadius()*2.f};
+    consider(pad.getGlobalBounds(), PADDLE_ID);
 
-    return (ballBounds.intersects(block.getGlobalBounds()));
+    return first;
 }
 
-// Calcul "size" rect between 2 points
-sf::Vector2f sizeRectFromPoints(const sf::Vector2f& A, const sf::Vector2f& B)
+/// ///////////////////////////////////////////////
+/// LEVELS
+// Short levels sit at the top of the screen, tall ones start with their
+// bottom rows on the scroll line
+void startLevel(ChunkedLevel& world, Effects& effects)
 {
-    return sf::Vector2f{static_cast<float>(fabs(B.x - A.x)),
-                        static_cast<float>(fabs(B.y - A.y))};
+    world.setCamera(std::max(world.getHeight() - SCROLL_LIMIT, 0.f));
+    world.update();
+    effects.clear();
+    effects.setBlockTexture(world.getTexture());
 }
 
 /// ///////////////////////////////////////////////
 /// MAIN
 int main()
 {
+    /////// Assets (the archive decodes while the window opens, loose files without it)
+    sf::Clock startup;
+    AssetLoader assets;
+    if(!assets.open("assets.pak"))
+        std::cout << "No asset archive (" << assets.getError() << "), loose files\n";
+    assets.start();
+    auto loadTexture = [&](sf::Texture& texture, const std::string& fileName){
+        const AssetLoader::ImageHandle image{assets.getImage(fileName)};
+        if(!image || !texture.loadFromImage(*image))
+            std::cout << "Assets : " << (image ? "can't create a texture for " + fileName : assets.getError()) << '\n';
+    };
+
     sf::RenderWindow window(sf::VideoMode(1024, 576), "Block Breaker", sf::Style::Close);
 
     /////// Paddle
@@ -435,26 +278,58 @@ int main()
     myBall.setPosition(WINDOW_W/2.f, PAD_Y - 24.f);
 
     /////// Blocks Grid
-    sf::Texture blk_texture;
-    blk_texture.loadFromFile("assets/img/blk-texture.png");
+    std::vector<sf::Texture> blk_textures(1);
+    loadTexture(blk_textures[0], "assets/img/blk-texture.png");
 
-    std::vector<bool> gridBool{1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    Matrix<bool> gridBool(GRID_ROWS, GRID_COLS, {1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
                                1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
                                1, 0, 0, 0, 0, 0, 0, 0, 0, 1,
                                1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
                                1, 0, 0, 0, 0, 0, 0, 0, 0, 1,
                                1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
                                1, 1, 1, 1, 0, 0, 1, 1, 1, 1,
-                               1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
-
-    Matrix<Block> gridBlocks(GRID_ROWS, GRID_COLS, Block{});
-    for(std::size_t i=0; i<GRID_ROWS; ++i){
-        for(std::size_t j=0; j<GRID_COLS; ++j){
-            gridBlocks(i, j) = Block{sf::Vector2f{BLOCK_W, BLOCK_H}, &blk_texture, gridBool[(i*GRID_COLS)+j]};
-            gridBlocks(i, j).setPosition((j*BLOCK_W)+origin_grid.x, i*BLOCK_H);
+                               1, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+
+    Level builtIn{"Classic", 0, Matrix<LevelCell>(GRID_ROWS, GRID_COLS)};
+    for(std::size_t i=0; i<GRID_ROWS; ++i)
+        for(std::size_t j=0; j<GRID_COLS; ++j)
+            if(gridBool(i, j))
+                builtIn.cells(i, j) = LevelCell{blockType::NORMAL, 3};
+
+    // Declared first : a prefetch still running reads the pack
+    LevelPack levels;
+    ChunkedLevel world{sf::Vector2f{BLOCK_W, BLOCK_H}, sf::Vector2f(WINDOW_W, WINDOW_H)};
+
+    /////// Particles (debris, sparks, score pop-ups)
+    Effects effects{PARTICLES_DEBRIS, PARTICLES_FX};
+    unsigned long score{0};
+
+    world.load(builtIn, &blk_textures[0]);
+    startLevel(world, effects);
+
+    /////// Level pack (built-in level above if there is none)
+    // The next level is decoded and cut in chunks in the background while
+    // this one plays : a level switch only swaps the chunks in
+    std::vector<sf::Texture> levelTextures;
+    std::size_t levelId{0};
+    if(levels.open("assets/levels.pak")){
+        levelTextures = std::vector<sf::Texture>(levels.getTextures().size());
+        for(std::size_t t=0; t<levelTextures.size(); ++t)
+            loadTexture(levelTextures[t], levels.getTextures()[t]);
+
+        if(levels.count() > 0 && world.take(levels, levelId, levelTextures)){
+            startLevel(world, effects);
+            std::cout << "Level 1/" << levels.count() << " : " << world.getName() << '\n';
         }
+        world.prefetch(levels, levelId + 1);
+    }
+    else{
+        std::cout << "No level pack (" << levels.getError() << "), built-in level\n";
     }
 
+    assets.printStats(std::cout);
+    std::cout << "Startup : " << startup.getElapsedTime().asMilliseconds() << " ms\n";
+
     /// DEBUG
     sf::RectangleShape boxBall{{myBall.getRadius()*2.f, myBall.getRadius()*2.f}};
     boxBall.setFillColor(sf::Color::Transparent);
@@ -462,14 +337,39 @@ int main()
     boxBall.setOutlineColor(sf::Color::Red);
     /// END DEBUG
 
-    /////// CLOCK/DT
-    sf::Clock clock;
-    sf::Time dt;
+    /////// LOOP (120 fixed steps/s, 120 fps at most)
+    GameLoop loop(1.f / 120.f, 120);
+    const sf::Time dt{sf::seconds(loop.getStep())};
+
+    // Positions before the last step : frames are drawn in between
+    sf::Vector2f ballFrom{myBall.getPosition()}, padFrom{pad.getPosition()};
+
+    /////// MULTI-BALL (M : +2 balls, B : +10000 stress balls, N : clear)
+    BallSwarm swarm{SWARM_RADIUS, sf::FloatRect{0.f, 0.f, static_cast<float>(WINDOW_W), static_cast<float>(WINDOW_H)}};
+    Matrix<std::uint8_t> aliveCells;
+    std::vector<std::size_t> swarmHits;
+
+    // Hit on a block : sparks, or debris and points if it broke
+    auto damage = [&](std::size_t row, std::size_t col){
+        const sf::FloatRect bounds{world.getBounds(row, col)};
+        if(world.takeDamage(row, col)){
+            effects.blockBroken(bounds, BLOCK_POINTS);
+            score += BLOCK_POINTS;
+        }
+        else{
+            effects.blockHit(bounds);
+        }
+    };
+
+    /////// COLLISION STATS (shown in the title once per second)
+    sf::Clock statsClock;
+    unsigned long statsTests{0}, statsSteps{0};
+    unsigned statsMax{0};
 
     /////// GAME LOOP
     while (window.isOpen())
     {
-        dt = clock.restart();
+        loop.beginFrame();
 
         /////// EVENTS
         sf::Event event;
@@ -482,6 +382,11 @@ int main()
                 if (event.key.code == sf::Keyboard::Q) { key[LEFT]  = true; }
                 if (event.key.code == sf::Keyboard::D) { key[RIGHT] = true; }
 
+                // Multi-ball
+                if (event.key.code == sf::Keyboard::M) { swarm.spawn(myBall.getPosition(), SPEEDBALL, 200.f, 340.f, 2); }
+                if (event.key.code == sf::Keyboard::B) { swarm.spawn(pad.getPosition() + sf::Vector2f(PAD_W/2.f, -SWARM_RADIUS), 2.f*SPEEDBALL, 200.f, 340.f, SWARM_STRESS); }
+                if (event.key.code == sf::Keyboard::N) { swarm.clear(); }
+
                 if(event.key.code == sf::Keyboard::Escape)
                     window.close();
             }
@@ -512,37 +417,122 @@ int main()
                 window.close();
         }
 
-        /////// UPDATE
-        if(key[LEFT])  pad.move(dt, keys::LEFT);
-        if(key[RIGHT]) pad.move(dt, keys::RIGHT);
+        /////// UPDATE (fixed steps)
+        while(loop.step()) {
+            ballFrom = myBall.getPosition();
+            padFrom  = pad.getPosition();
+
+            if(key[LEFT])  pad.move(dt, keys::LEFT);
+            if(key[RIGHT]) pad.move(dt, keys::RIGHT);
+
+            // Ball : moved up to its earliest impact, bounced, then moved on
+            // with the rest of the step, so it can't tunnel at any speed
+            unsigned tests{0};
+            sf::Vector2f center{myBall.getPosition()};
+            sf::Vector2f velocity{myBall.getVelocity()};
+            Collision::moveCircle(center, velocity, dt.asSeconds(),
+                [&](const sf::Vector2f& from, const sf::Vector2f& delta){
+                    return firstContact(from, myBall.getRadius(), delta, world, pad, tests);
+                },
+                [&](const Collision::Contact& contact, sf::Vector2f& vel){
+                    if(contact.id == PADDLE_ID && contact.hit.normal.y < 0.f){
+                        // Top of the paddle : angle from the impact point
+                        myBall.setPosition(center);
+                        myBall.bounce(pad);
+                        vel = myBall.getVelocity();
+                        return;
+                    }
+                    vel = Collision::reflect(vel, contact.hit.normal);
+                    if(contact.id != PADDLE_ID)
+                        damage(contact.id / world.cols(), contact.id % world.cols());
+                });
+            myBall.setPosition(center);
+            myBall.setVelocity(velocity);
+
+            // Swarm : sees the blocks still alive on screen, damages the ones it hits
+            if(swarm.size() > 0){
+                const std::size_t firstRow{world.firstVisibleRow()};
+                if(aliveCells.rows() != world.visibleRows() || aliveCells.cols() != world.cols())
+                    aliveCells = Matrix<std::uint8_t>(world.visibleRows(), world.cols(), 0);
+                for(std::size_t i=0; i<aliveCells.rows(); ++i)
+                    for(std::size_t j=0; j<aliveCells.cols(); ++j)
+                        aliveCells(i, j) = world.isAlive(firstRow + i, j) ? 1 : 0;
+
+                swarmHits.clear();
+                swarm.update(dt.asSeconds(), SwarmGrid{world.getOrigin() + sf::Vector2f(0.f, firstRow * BLOCK_H), BLOCK_W, BLOCK_H,
+                                                       aliveCells.rows(), aliveCells.cols(), aliveCells.data()},
+                             pad.getGlobalBounds(), swarmHits);
+                for(auto id : swarmHits)
+                    damage(firstRow + (id / aliveCells.cols()), id % aliveCells.cols());
+            }
 
-        myBall.move(dt);
+            effects.update(dt.asSeconds());
 
-        if(collideWithPaddle(myBall, pad)){
-            myBall.bounce(pad);
-        }
+            // Scroll : the level comes down while the blocks are far enough
+            if(world.getCamera() > 0.f && world.lowestBreakable() < SCROLL_LIMIT)
+                world.setCamera(std::max(world.getCamera() - (SCROLL_SPEED * dt.asSeconds()), 0.f));
+            world.update();
 
-        for(auto&& block : gridBlocks){
-            if(block.isAlive()){
-                if(collideWithBlock(myBall, block)){
-                    myBall.bounce(block);
-                    block.takeDamage();
+            // Level cleared : next one is already cut in chunks
+            if(levels.count() > 0 && world.breakableLeft() == 0){
+                levelId = (levelId + 1) % levels.count();
+                if(world.take(levels, levelId, levelTextures)){
+                    startLevel(world, effects);
+                    std::cout << "Level " << (levelId + 1) << '/' << levels.count() << " : " << world.getName() << '\n';
                 }
+                world.prefetch(levels, (levelId + 1) % levels.count());
+
+                myBall.setPosition(WINDOW_W/2.f, PAD_Y - 24.f);
+                myBall.setRotation(270.f);
+                swarm.clear();
+                ballFrom = myBall.getPosition();
             }
+
+            statsTests += tests;
+            statsMax    = std::max(statsMax, tests);
+            ++statsSteps;
         }
 
+        if(statsClock.getElapsedTime().asSeconds() >= 1.f){
+            window.setTitle("Block Breaker - " + std::to_string(static_cast<long>(loop.getStats().fps + 0.5f)) + " fps, frame " +
+                            std::to_string(loop.getStats().frameMs).substr(0, 4) + " ms - block tests/step : " +
+                            std::to_string(static_cast<double>(statsTests) / std::max(1ul, statsSteps)).substr(0, 4) +
+                            " (max " + std::to_string(statsMax) + ")" +
+                            (swarm.size() > 0 ? " - " + std::to_string(swarm.size()) + " balls, " +
+                                                std::to_string(static_cast<long>(swarm.getBallsPerMs())) + " balls/ms" : "") +
+                            " - chunks live " + std::to_string(world.liveChunks()) + "/" + std::to_string(world.chunkCount()) +
+                            ", cleared " + std::to_string(world.clearedChunks()) +
+                            ", blocks left " + std::to_string(world.breakableLeft()) +
+                            " - particles " + std::to_string(effects.size()) + "/" + std::to_string(effects.capacity()) +
+                            " (dropped " + std::to_string(effects.getDropped()) + "), update " +
+                            std::to_string(effects.getUpdateTime()).substr(0, 5) + " ms, draw " +
+                            std::to_string(effects.getDrawTime()).substr(0, 5) + " ms - score " + std::to_string(score));
+            statsTests  = 0;
+            statsSteps  = 0;
+            statsMax    = 0;
+            statsClock.restart();
+        }
+
+        // Ball and paddle, 'alpha' of the way from the previous step
+        const float alpha{loop.getAlpha()};
+        const sf::Transform ballShift{sf::Transform().translate((ballFrom - myBall.getPosition()) * (1.f - alpha))};
+        const sf::Transform padShift{sf::Transform().translate((padFrom - pad.getPosition()) * (1.f - alpha))};
+
         /// DEBUG
         boxBall.setPosition(myBall.getGlobalBounds().left, myBall.getGlobalBounds().top);
         /// END DEBUF
 
         /////// DRAW
         window.clear();
-        window.draw(pad);
-        window.draw(myBall);
-        for(const auto& block : gridBlocks)
-            window.draw(block);
-        window.draw(boxBall);
+        window.draw(pad, padShift);
+        window.draw(myBall, ballShift);
+        window.draw(swarm);
+        window.draw(world);
+        window.draw(effects);
+        window.draw(boxBall, ballShift);
         window.display();
+
+        loop.endFrame(window.hasFocus());
     }
 
     return 0;
@@ -0,0 +1,300 @@
+#include "../include/BallSwarm.h"
+#include "../../Utilities/Random.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+// 32-bit MinGW only defines __SSE2__ with -msse2 (set in the .cbp) ;
+// without it, the scalar loops below do all the work
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define BALLSWARM_SSE2
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+namespace {
+
+const float        PI_F{3.141592f};
+const unsigned     TEXTURE_SIZE{32};
+
+// Stress balls use discrete tests : sub-steps keep each move under a radius
+const unsigned     MAX_SUBSTEPS{8};
+
+#ifdef BALLSWARM_SSE2
+// Lowest set bit of a lane mask (not 0)
+inline int lowestLane(int mask)
+{
+#ifdef _MSC_VER
+    unsigned long lane;
+    _BitScanForward(&lane, static_cast<unsigned long>(mask));
+    return static_cast<int>(lane);
+#else
+    return __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+}
+#endif
+
+} // namespace
+
+BallSwarm::BallSwarm(float radius, const sf::FloatRect& bounds) :
+    m_radius{radius},
+    m_bounds(bounds),
+    m_x(), m_y(), m_vx(), m_vy(),
+    m_maxSpeed{0.f},
+    m_ballsPerMs{0.},
+    m_texture(),
+    m_vertices(sf::Quads)
+{
+    // White disc, tinted per vertex
+    sf::Image disc;
+    disc.create(TEXTURE_SIZE, TEXTURE_SIZE, sf::Color::Transparent);
+    const float half{TEXTURE_SIZE / 2.f};
+    for(unsigned i=0; i<TEXTURE_SIZE; ++i){
+        for(unsigned j=0; j<TEXTURE_SIZE; ++j){
+            const float dx{j + 0.5f - half}, dy{i + 0.5f - half};
+            if((dx*dx) + (dy*dy) <= half*half)
+                disc.setPixel(j, i, sf::Color::White);
+        }
+    }
+    m_texture.loadFromImage(disc);
+    m_texture.setSmooth(true);
+}
+
+////////// SPAWN / CLEAR
+void BallSwarm::spawn(const sf::Vector2f& position, float speed, float angleMinDeg, float angleMaxDeg, std::size_t count)
+{
+    const std::size_t total{m_x.size() + count};
+    m_x.reserve(total);
+    m_y.reserve(total);
+    m_vx.reserve(total);
+    m_vy.reserve(total);
+
+    Random::Generator& generator = Random::local();
+    for(std::size_t i=0; i<count; ++i){
+        const float deg{generator.uniform(angleMinDeg, angleMaxDeg)};
+        const float rad{(PI_F * deg) / 180.f};
+        m_x.push_back(position.x);
+        m_y.push_back(position.y);
+        m_vx.push_back(std::cos(rad) * speed);
+        m_vy.push_back(std::sin(rad) * speed);
+    }
+
+    m_maxSpeed = std::max(m_maxSpeed, speed);
+}
+
+void BallSwarm::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_vertices.clear();
+    m_maxSpeed   = 0.f;
+    m_ballsPerMs = 0.;
+}
+
+////////// UPDATE
+void BallSwarm::update(float dt, const SwarmGrid& grid, const sf::FloatRect& paddle, std::vector<std::size_t>& hits)
+{
+    if(m_x.empty())
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const float travel{m_maxSpeed * dt};
+    const unsigned steps{std::min(MAX_SUBSTEPS, std::max(1u, static_cast<unsigned>(std::ceil(travel / m_radius))))};
+    const float h{dt / steps};
+
+    for(unsigned s=0; s<steps; ++s){
+        integrate(h);
+        collidePaddle(paddle);
+        collideGrid(grid, hits);
+    }
+
+    const double ms{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()};
+    m_ballsPerMs = (ms > 0.) ? m_x.size() / ms : 0.;
+
+    updateVertices();
+}
+
+// Move + bounce on the bounds
+void BallSwarm::integrate(float dt)
+{
+    const std::size_t n{m_x.size()};
+    const float minX{m_bounds.left + m_radius}, maxX{m_bounds.left + m_bounds.width - m_radius};
+    const float minY{m_bounds.top + m_radius},  maxY{m_bounds.top + m_bounds.height - m_radius};
+    std::size_t i{0};
+
+#ifdef BALLSWARM_SSE2
+    const __m128 vdt{_mm_set1_ps(dt)};
+    const __m128 sign{_mm_set1_ps(-0.f)};
+    auto axis = [&](float *p, float *v, float lo, float hi){
+        const __m128 vlo{_mm_set1_ps(lo)}, vhi{_mm_set1_ps(hi)};
+        __m128 pos{_mm_loadu_ps(p)};
+        __m128 vel{_mm_loadu_ps(v)};
+        pos = _mm_add_ps(pos, _mm_mul_ps(vel, vdt));
+        // Out of bounds : flip the velocity sign toward the inside, clamp
+        const __m128 under{_mm_and_ps(_mm_cmplt_ps(pos, vlo), _mm_cmplt_ps(vel, _mm_setzero_ps()))};
+        const __m128 over{_mm_and_ps(_mm_cmpgt_ps(pos, vhi), _mm_cmpgt_ps(vel, _mm_setzero_ps()))};
+        vel = _mm_xor_ps(vel, _mm_and_ps(_mm_or_ps(under, over), sign));
+        pos = _mm_min_ps(_mm_max_ps(pos, vlo), vhi);
+        _mm_storeu_ps(p, pos);
+        _mm_storeu_ps(v, vel);
+    };
+    for(; i+4<=n; i+=4){
+        axis(&m_x[i], &m_vx[i], minX, maxX);
+        axis(&m_y[i], &m_vy[i], minY, maxY);
+    }
+#endif
+
+    for(; i<n; ++i){
+        m_x[i] += m_vx[i] * dt;
+        m_y[i] += m_vy[i] * dt;
+        if((m_x[i] < minX && m_vx[i] < 0.f) || (m_x[i] > maxX && m_vx[i] > 0.f)) m_vx[i] = -m_vx[i];
+        if((m_y[i] < minY && m_vy[i] < 0.f) || (m_y[i] > maxY && m_vy[i] > 0.f)) m_vy[i] = -m_vy[i];
+        m_x[i] = std::min(std::max(m_x[i], minX), maxX);
+        m_y[i] = std::min(std::max(m_y[i], minY), maxY);
+    }
+}
+
+// Paddle : balls going down on its top are sent back up
+void BallSwarm::collidePaddle(const sf::FloatRect& paddle)
+{
+    const std::size_t n{m_x.size()};
+    const float left{paddle.left - m_radius}, right{paddle.left + paddle.width + m_radius};
+    const float top{paddle.top - m_radius},   bottom{paddle.top + paddle.height};
+
+    auto narrow = [&](std::size_t k){
+        if(m_vy[k] > 0.f && m_x[k] >= left && m_x[k] <= right && m_y[k] >= top && m_y[k] <= bottom){
+            m_vy[k] = -m_vy[k];
+            m_y[k]  = top;
+        }
+    };
+
+    std::size_t i{0};
+#ifdef BALLSWARM_SSE2
+    // Broad phase on four balls : most of them are nowhere near the paddle
+    const __m128 vtop{_mm_set1_ps(top)}, vleft{_mm_set1_ps(left)}, vright{_mm_set1_ps(right)};
+    for(; i+4<=n; i+=4){
+        const __m128 x{_mm_loadu_ps(&m_x[i])}, y{_mm_loadu_ps(&m_y[i])};
+        const __m128 near{_mm_and_ps(_mm_cmpge_ps(y, vtop),
+                                     _mm_and_ps(_mm_cmpge_ps(x, vleft), _mm_cmple_ps(x, vright)))};
+        int mask{_mm_movemask_ps(near)};
+        while(mask){
+            const int lane{lowestLane(mask)};
+            narrow(i + lane);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for(; i<n; ++i)
+        narrow(i);
+}
+
+// Blocks : balls over the grid area look up the cells under their bounds
+void BallSwarm::collideGrid(const SwarmGrid& grid, std::vector<std::size_t>& hits)
+{
+    const std::size_t n{m_x.size()};
+    const float gridL{grid.origin.x - m_radius}, gridR{grid.origin.x + (grid.cols * grid.cellW) + m_radius};
+    const float gridT{grid.origin.y - m_radius}, gridB{grid.origin.y + (grid.rows * grid.cellH) + m_radius};
+
+    auto narrow = [&](std::size_t k){
+        const float x{m_x[k]}, y{m_y[k]};
+        const float c0{std::floor((x - m_radius - grid.origin.x) / grid.cellW)};
+        const float c1{std::floor((x + m_radius - grid.origin.x) / grid.cellW)};
+        const float r0{std::floor((y - m_radius - grid.origin.y) / grid.cellH)};
+        const float r1{std::floor((y + m_radius - grid.origin.y) / grid.cellH)};
+
+        for(float r=std::max(r0, 0.f); r<=r1 && r<grid.rows; ++r){
+            for(float c=std::max(c0, 0.f); c<=c1 && c<grid.cols; ++c){
+                const std::size_t id{static_cast<std::size_t>(r) * grid.cols + static_cast<std::size_t>(c)};
+                if(!grid.alive[id])
+                    continue;
+
+                // Circle vs cell
+                const float left{grid.origin.x + c * grid.cellW}, top{grid.origin.y + r * grid.cellH};
+                const float qx{std::min(std::max(x, left), left + grid.cellW)};
+                const float qy{std::min(std::max(y, top), top + grid.cellH)};
+                const float dx{x - qx}, dy{y - qy};
+                if((dx*dx) + (dy*dy) > m_radius*m_radius)
+                    continue;
+
+                // Reflect on the axis of least penetration, push out
+                const float penX{m_radius - std::abs(dx)}, penY{m_radius - std::abs(dy)};
+                if((dx != 0.f && penX < penY) || dy == 0.f){
+                    const float side{(dx != 0.f) ? (dx > 0.f ? 1.f : -1.f) : (m_vx[k] > 0.f ? -1.f : 1.f)};
+                    m_vx[k] = side * std::abs(m_vx[k]);
+                    m_x[k] += side * penX;
+                }
+                else{
+                    const float side{dy > 0.f ? 1.f : -1.f};
+                    m_vy[k] = side * std::abs(m_vy[k]);
+                    m_y[k] += side * penY;
+                }
+                hits.push_back(id);
+                return;
+            }
+        }
+    };
+
+    std::size_t i{0};
+#ifdef BALLSWARM_SSE2
+    const __m128 vl{_mm_set1_ps(gridL)}, vr{_mm_set1_ps(gridR)};
+    const __m128 vt{_mm_set1_ps(gridT)}, vb{_mm_set1_ps(gridB)};
+    for(; i+4<=n; i+=4){
+        const __m128 x{_mm_loadu_ps(&m_x[i])}, y{_mm_loadu_ps(&m_y[i])};
+        const __m128 inside{_mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(x, vl), _mm_cmplt_ps(x, vr)),
+                                       _mm_and_ps(_mm_cmpgt_ps(y, vt), _mm_cmplt_ps(y, vb)))};
+        int mask{_mm_movemask_ps(inside)};
+        while(mask){
+            const int lane{lowestLane(mask)};
+            narrow(i + lane);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for(; i<n; ++i){
+        if(m_x[i] > gridL && m_x[i] < gridR && m_y[i] > gridT && m_y[i] < gridB)
+            narrow(i);
+    }
+}
+
+////////// RENDER (one textured quad per ball, one draw call)
+void BallSwarm::updateVertices()
+{
+    const std::size_t n{m_x.size()};
+    const float ts{static_cast<float>(TEXTURE_SIZE)};
+
+    // Texture coordinates only for new quads
+    const std::size_t known{m_vertices.getVertexCount() / 4};
+    m_vertices.resize(n * 4);
+    for(std::size_t i=known; i<n; ++i){
+        sf::Vertex *quad = &m_vertices[i * 4];
+        quad[0].texCoords = sf::Vector2f(0.f, 0.f);
+        quad[1].texCoords = sf::Vector2f(ts, 0.f);
+        quad[2].texCoords = sf::Vector2f(ts, ts);
+        quad[3].texCoords = sf::Vector2f(0.f, ts);
+    }
+
+    for(std::size_t i=0; i<n; ++i){
+        sf::Vertex *quad = &m_vertices[i * 4];
+        const float l{m_x[i] - m_radius}, t{m_y[i] - m_radius};
+        const float r{m_x[i] + m_radius}, b{m_y[i] + m_radius};
+        quad[0].position = sf::Vector2f(l, t);
+        quad[1].position = sf::Vector2f(r, t);
+        quad[2].position = sf::Vector2f(r, b);
+        quad[3].position = sf::Vector2f(l, b);
+    }
+}
+
+void BallSwarm::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    if(m_vertices.getVertexCount() == 0)
+        return;
+
+    states.texture = &m_texture;
+    target.draw(m_vertices, states);
+}
@@ -0,0 +1,332 @@
+#include "../include/ChunkedLevel.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+// blk-texture.png : 3 frames side by side (1, 2, 3+ hits left)
+const float FRAME_W{60.f};
+const float FRAME_H{24.f};
+
+// Chunks are made live one chunk ahead of the screen and evicted two
+// chunks away, so a camera going back and forth doesn't thrash
+const std::size_t LIVE_MARGIN{1};
+const std::size_t KEEP_MARGIN{2};
+
+sf::Color blockColor(const LevelCell& cell)
+{
+    if(cell.type == blockType::UNBREAKABLE)
+        return sf::Color(120, 120, 120);
+    if(cell.hp > 3)
+        return sf::Color(200, 150, 150);
+    return sf::Color::White;
+}
+
+} // namespace
+
+ChunkedLevel::ChunkedLevel(const sf::Vector2f& blockSize, const sf::Vector2f& viewSize) :
+    m_blockSize(blockSize),
+    m_viewSize(viewSize),
+    m_texture{nullptr},
+    m_chunks(),
+    m_rows{0}, m_cols{0},
+    m_left{0.f},
+    m_camera{0.f},
+    m_liveBegin{0}, m_liveEnd{0},
+    m_liveCount{0}, m_clearedCount{0},
+    m_breakable{0},
+    m_name(),
+    m_next(),
+    m_nextIndex{0}
+{
+
+}
+
+////////// LOAD (every chunk starts compact)
+void ChunkedLevel::load(const Level& level, const sf::Texture *texture)
+{
+    Layout layout{cut(level, maxCols())};
+    install(layout, texture);
+}
+
+// Touches no member : runs on the prefetch thread too
+ChunkedLevel::Layout ChunkedLevel::cut(const Level& level, std::size_t maxCols)
+{
+    Layout layout;
+    layout.name    = level.name;
+    layout.texture = level.texture;
+    layout.rows    = level.cells.rows();
+    layout.cols    = std::min(level.cells.cols(), maxCols);
+    layout.valid   = true;
+    layout.chunks.resize((layout.rows + CHUNK_ROWS - 1) / CHUNK_ROWS);
+
+    std::vector<LevelCell> cells;
+    for(std::size_t c=0; c<layout.chunks.size(); ++c){
+        Chunk& chunk = layout.chunks[c];
+        cells.clear();
+        for(std::size_t i=c*CHUNK_ROWS; i<std::min((c+1)*CHUNK_ROWS, layout.rows); ++i){
+            for(std::size_t j=0; j<layout.cols; ++j){
+                const LevelCell& cell = level.cells(i, j);
+                cells.push_back(cell);
+                if(cell.type != blockType::EMPTY){
+                    ++chunk.solid;
+                    if(cell.type != blockType::UNBREAKABLE)
+                        ++chunk.breakable;
+                }
+            }
+        }
+        layout.breakable += chunk.breakable;
+
+        if(chunk.solid == 0){
+            chunk.state = CLEARED;
+            ++layout.cleared;
+        }
+        else{
+            LevelPack::encodeRuns(cells.data(), cells.size(), chunk.runs);
+        }
+    }
+    return layout;
+}
+
+// Chunks are moved in : no cell is looked at
+void ChunkedLevel::install(Layout& layout, const sf::Texture *texture)
+{
+    m_texture      = texture;
+    m_rows         = layout.rows;
+    m_cols         = layout.cols;
+    m_left         = (m_viewSize.x - (m_cols * m_blockSize.x)) / 2.f;
+    m_camera       = 0.f;
+    m_liveBegin    = m_liveEnd = 0;
+    m_liveCount    = 0;
+    m_clearedCount = layout.cleared;
+    m_breakable    = layout.breakable;
+    m_name         = layout.name;
+    m_chunks.swap(layout.chunks);
+}
+
+std::size_t ChunkedLevel::maxCols() const
+{
+    return static_cast<std::size_t>(m_viewSize.x / m_blockSize.x);
+}
+
+////////// NEXT LEVEL
+void ChunkedLevel::prefetch(const LevelPack& pack, std::size_t index)
+{
+    if(index >= pack.count() || (m_next.valid() && m_nextIndex == index))
+        return;
+
+    // A previous prefetch still running is waited for by the future's destructor
+    m_nextIndex = index;
+    const std::size_t cols{maxCols()};
+    m_next = std::async(std::launch::async, [&pack, index, cols]{
+        Level level;
+        return pack.decode(index, level) ? cut(level, cols) : Layout();
+    });
+}
+
+bool ChunkedLevel::take(const LevelPack& pack, std::size_t index, const std::vector<sf::Texture>& textures)
+{
+    Layout layout;
+    if(m_next.valid() && m_nextIndex == index){
+        layout = m_next.get();
+    }
+    else{
+        Level level;
+        if(pack.decode(index, level))
+            layout = cut(level, maxCols());
+    }
+    if(!layout.valid)
+        return false;
+
+    install(layout, (layout.texture < textures.size()) ? &textures[layout.texture] : nullptr);
+    return true;
+}
+
+////////// UPDATE
+void ChunkedLevel::update()
+{
+    if(m_chunks.empty())
+        return;
+
+    const std::size_t first{chunkAt(m_camera)}, last{chunkAt(m_camera + m_viewSize.y)};
+    const std::size_t liveBegin{first > LIVE_MARGIN ? first - LIVE_MARGIN : 0};
+    const std::size_t liveEnd{std::min(last + LIVE_MARGIN + 1, m_chunks.size())};
+    const std::size_t keepBegin{first > KEEP_MARGIN ? first - KEEP_MARGIN : 0};
+    const std::size_t keepEnd{std::min(last + KEEP_MARGIN + 1, m_chunks.size())};
+
+    // Only the previous live range is looked at, never the whole level
+    for(std::size_t c=m_liveBegin; c<m_liveEnd; ++c)
+        if(c < keepBegin || c >= keepEnd)
+            evict(m_chunks[c]);
+
+    m_liveBegin = std::min(std::max(m_liveBegin, keepBegin), liveBegin);
+    m_liveEnd   = std::max(std::min(m_liveEnd, keepEnd), liveEnd);
+
+    for(std::size_t c=m_liveBegin; c<m_liveEnd; ++c){
+        Chunk& chunk = m_chunks[c];
+        if(chunk.state == COMPACT && c >= liveBegin && c < liveEnd)
+            activate(chunk, c);
+        if(chunk.state == LIVE && chunk.dirty)
+            rebuild(chunk, c);
+    }
+}
+
+////////// CELLS
+std::size_t ChunkedLevel::firstVisibleRow() const
+{
+    const float row{std::floor(m_camera / m_blockSize.y)};
+    return std::min(static_cast<std::size_t>(std::max(row, 0.f)), m_rows);
+}
+
+std::size_t ChunkedLevel::visibleRows() const
+{
+    const float row{std::ceil((m_camera + m_viewSize.y) / m_blockSize.y)};
+    return std::min(static_cast<std::size_t>(std::max(row, 0.f)), m_rows) - firstVisibleRow();
+}
+
+bool ChunkedLevel::isAlive(std::size_t row, std::size_t col) const
+{
+    if(row >= m_rows || col >= m_cols)
+        return false;
+
+    const Chunk& chunk = m_chunks[row / CHUNK_ROWS];
+    return chunk.state == LIVE && chunk.cells(row % CHUNK_ROWS, col).type != blockType::EMPTY;
+}
+
+sf::FloatRect ChunkedLevel::getBounds(std::size_t row, std::size_t col) const
+{
+    return sf::FloatRect{m_left + (col * m_blockSize.x), (row * m_blockSize.y) - m_camera,
+                         m_blockSize.x, m_blockSize.y};
+}
+
+bool ChunkedLevel::takeDamage(std::size_t row, std::size_t col)
+{
+    if(row >= m_rows || col >= m_cols)
+        return false;
+
+    Chunk& chunk = m_chunks[row / CHUNK_ROWS];
+    if(chunk.state != LIVE)
+        return false;
+
+    LevelCell& cell = chunk.cells(row % CHUNK_ROWS, col);
+    if(cell.type == blockType::EMPTY || cell.type == blockType::UNBREAKABLE)
+        return false;
+
+    chunk.dirty = true;
+    if(--cell.hp != 0)
+        return false;
+
+    cell = LevelCell{};
+    --chunk.solid;
+    --chunk.breakable;
+    --m_breakable;
+    if(chunk.solid == 0)
+        release(chunk);
+    return true;
+}
+
+float ChunkedLevel::lowestBreakable() const
+{
+    for(std::size_t c=m_liveEnd; c>m_liveBegin; --c){
+        const Chunk& chunk = m_chunks[c-1];
+        if(chunk.state == LIVE && chunk.lowest > 0)
+            return (((c-1) * CHUNK_ROWS) + chunk.lowest) * m_blockSize.y - m_camera;
+    }
+    return std::numeric_limits<float>::lowest();
+}
+
+////////// CHUNKS
+std::size_t ChunkedLevel::chunkRows(std::size_t chunk) const
+{
+    return std::min(CHUNK_ROWS, m_rows - (chunk * CHUNK_ROWS));
+}
+
+std::size_t ChunkedLevel::chunkAt(float y) const
+{
+    const float row{std::floor(y / m_blockSize.y)};
+    const std::size_t chunk{static_cast<std::size_t>(std::max(row, 0.f)) / CHUNK_ROWS};
+    return std::min(chunk, m_chunks.size() - 1);
+}
+
+void ChunkedLevel::activate(Chunk& chunk, std::size_t index)
+{
+    chunk.cells = Matrix<LevelCell>(chunkRows(index), m_cols);
+    LevelPack::decodeRuns(chunk.runs.data(), chunk.runs.data() + chunk.runs.size(),
+                          chunk.cells.data(), chunk.cells.size());
+    chunk.runs  = std::vector<std::uint8_t>();
+    chunk.state = LIVE;
+    chunk.dirty = true;
+    ++m_liveCount;
+}
+
+// Back to run length, damages included
+void ChunkedLevel::evict(Chunk& chunk)
+{
+    if(chunk.state != LIVE)
+        return;
+
+    LevelPack::encodeRuns(chunk.cells.data(), chunk.cells.size(), chunk.runs);
+    chunk.cells    = Matrix<LevelCell>();
+    chunk.vertices = sf::VertexArray(sf::Quads);
+    chunk.state    = COMPACT;
+    --m_liveCount;
+}
+
+// No block left : nothing to keep
+void ChunkedLevel::release(Chunk& chunk)
+{
+    if(chunk.state == LIVE)
+        --m_liveCount;
+
+    chunk.runs     = std::vector<std::uint8_t>();
+    chunk.cells    = Matrix<LevelCell>();
+    chunk.vertices = sf::VertexArray(sf::Quads);
+    chunk.lowest   = 0;
+    chunk.dirty    = false;
+    chunk.state    = CLEARED;
+    ++m_clearedCount;
+}
+
+// One quad per alive block, in world coordinates
+void ChunkedLevel::rebuild(Chunk& chunk, std::size_t index)
+{
+    chunk.vertices.clear();
+    chunk.lowest = 0;
+
+    const float top{index * CHUNK_ROWS * m_blockSize.y};
+    for(std::size_t i=0; i<chunk.cells.rows(); ++i){
+        for(std::size_t j=0; j<m_cols; ++j){
+            const LevelCell& cell = chunk.cells(i, j);
+            if(cell.type == blockType::EMPTY)
+                continue;
+            if(cell.type != blockType::UNBREAKABLE)
+                chunk.lowest = i + 1;
+
+            const float x{j * m_blockSize.x}, y{top + (i * m_blockSize.y)};
+            const float u{FRAME_W * (std::min<int>(cell.hp, 3) - 1)};
+            const sf::Color color{blockColor(cell)};
+            chunk.vertices.append(sf::Vertex{{x, y}, color, {u, 0.f}});
+            chunk.vertices.append(sf::Vertex{{x + m_blockSize.x, y}, color, {u + FRAME_W, 0.f}});
+            chunk.vertices.append(sf::Vertex{{x + m_blockSize.x, y + m_blockSize.y}, color, {u + FRAME_W, FRAME_H}});
+            chunk.vertices.append(sf::Vertex{{x, y + m_blockSize.y}, color, {u, FRAME_H}});
+        }
+    }
+    chunk.dirty = false;
+}
+
+////////// DRAW (visible chunks only, one draw call each)
+void ChunkedLevel::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    if(m_chunks.empty())
+        return;
+
+    states.transform.translate(m_left, -m_camera);
+    states.texture = m_texture;
+
+    const std::size_t last{chunkAt(m_camera + m_viewSize.y)};
+    for(std::size_t c=chunkAt(m_camera); c<=last; ++c)
+        if(m_chunks[c].state == LIVE && m_chunks[c].vertices.getVertexCount() > 0)
+            target.draw(m_chunks[c].vertices, states);
+}
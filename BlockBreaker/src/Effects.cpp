@@ -0,0 +1,131 @@
+#include "../include/Effects.h"
+#include "../../Utilities/Random.hpp"
+
+#include <cmath>
+#include <string>
+
+namespace {
+
+const float PI_F{3.141592f};
+
+// blk-texture.png : frame of a block with 1 hit left, cut in 4 x 2 debris
+const float    FRAME_W{60.f};
+const float    FRAME_H{24.f};
+const unsigned DEBRIS_COLS{4};
+const unsigned DEBRIS_ROWS{2};
+
+// Fx texture : 8x8 disc, then 3x5 glyphs every 4 pixels ('0'-'9', '+')
+const unsigned DISC_SIZE{8};
+const unsigned GLYPH_W{3};
+const unsigned GLYPH_H{5};
+const unsigned GLYPH_STEP{4};
+const float    GLYPH_SCALE{3.f};
+const char    *GLYPHS[]{"111101101101111", "010110010010111", "111001111100111", "111001111001111",
+                        "101101111001001", "111100111001111", "111100111101111", "111001001001001",
+                        "111101111101111", "111101111001111", "000010111010000"};
+const unsigned GLYPH_COUNT{sizeof(GLYPHS) / sizeof(GLYPHS[0])};
+
+const sf::Color SPARK_COLOR{255, 220, 120};
+const sf::Color POPUP_COLOR{255, 240, 80};
+
+float random(int valmin, int valmax)
+{
+    return static_cast<float>(Random::between(valmin, valmax));
+}
+
+// Velocity of 'speed' toward a random angle of [angleMin, angleMax] degrees
+sf::Vector2f randomVelocity(int angleMin, int angleMax, int speedMin, int speedMax)
+{
+    const float rad{(PI_F * random(angleMin, angleMax)) / 180.f};
+    const float speed{random(speedMin, speedMax)};
+    return sf::Vector2f{std::cos(rad) * speed, std::sin(rad) * speed};
+}
+
+} // namespace
+
+Effects::Effects(std::size_t debrisCapacity, std::size_t fxCapacity) :
+    m_fxTexture(),
+    m_debris(debrisCapacity),
+    m_fx(fxCapacity, &m_fxTexture)
+{
+    sf::Image image;
+    image.create(DISC_SIZE + (GLYPH_COUNT * GLYPH_STEP), DISC_SIZE, sf::Color::Transparent);
+    const float half{DISC_SIZE / 2.f};
+    for(unsigned i=0; i<DISC_SIZE; ++i){
+        for(unsigned j=0; j<DISC_SIZE; ++j){
+            const float dx{j + 0.5f - half}, dy{i + 0.5f - half};
+            if((dx*dx) + (dy*dy) <= half*half)
+                image.setPixel(j, i, sf::Color::White);
+        }
+    }
+    for(unsigned g=0; g<GLYPH_COUNT; ++g)
+        for(unsigned i=0; i<GLYPH_H; ++i)
+            for(unsigned j=0; j<GLYPH_W; ++j)
+                if(GLYPHS[g][(i*GLYPH_W)+j] == '1')
+                    image.setPixel(DISC_SIZE + (g*GLYPH_STEP) + j, i, sf::Color::White);
+    m_fxTexture.loadFromImage(image);
+}
+
+////////// EMITTERS
+void Effects::blockHit(const sf::FloatRect& block)
+{
+    sparks(sf::Vector2f{block.left + (block.width / 2.f), block.top + block.height}, 6);
+}
+
+void Effects::blockBroken(const sf::FloatRect& block, unsigned points)
+{
+    const sf::Vector2f center{block.left + (block.width / 2.f), block.top + (block.height / 2.f)};
+
+    // Debris : the block in pieces, thrown away from its center
+    const sf::Vector2f piece{block.width / DEBRIS_COLS, block.height / DEBRIS_ROWS};
+    const sf::Vector2f texPiece{FRAME_W / DEBRIS_COLS, FRAME_H / DEBRIS_ROWS};
+    for(unsigned i=0; i<DEBRIS_ROWS; ++i){
+        for(unsigned j=0; j<DEBRIS_COLS; ++j){
+            const sf::Vector2f position{block.left + ((j + 0.5f) * piece.x), block.top + ((i + 0.5f) * piece.y)};
+            const sf::Vector2f velocity{(position.x - center.x) * 4.f + random(-30, 30), random(-160, -40)};
+            m_debris.emit(position, velocity, piece, sf::FloatRect{j * texPiece.x, i * texPiece.y, texPiece.x, texPiece.y},
+                          sf::Color::White, random(70, 110) / 100.f, 700.f);
+        }
+    }
+
+    sparks(center, 12);
+
+    // Pop-up : one particle per glyph, rising and slowing down
+    const std::string text{"+" + std::to_string(points)};
+    const float step{GLYPH_STEP * GLYPH_SCALE};
+    float x{center.x - (((text.size() - 1) * step) / 2.f)};
+    for(char ch : text){
+        const unsigned glyph{ch == '+' ? GLYPH_COUNT - 1 : static_cast<unsigned>(ch - '0')};
+        m_fx.emit(sf::Vector2f{x, center.y}, sf::Vector2f{0.f, -70.f},
+                  sf::Vector2f{GLYPH_W * GLYPH_SCALE, GLYPH_H * GLYPH_SCALE},
+                  sf::FloatRect(DISC_SIZE + (glyph * GLYPH_STEP), 0.f, GLYPH_W, GLYPH_H), POPUP_COLOR, 0.9f, 70.f);
+        x += step;
+    }
+}
+
+void Effects::sparks(const sf::Vector2f& center, unsigned count)
+{
+    for(unsigned k=0; k<count; ++k)
+        m_fx.emit(center, randomVelocity(0, 359, 80, 220), sf::Vector2f{4.f, 4.f},
+                  sf::FloatRect(0.f, 0.f, DISC_SIZE, DISC_SIZE), SPARK_COLOR, random(25, 45) / 100.f, 300.f);
+}
+
+////////// UPDATE
+void Effects::update(float dt)
+{
+    m_debris.update(dt);
+    m_fx.update(dt);
+}
+
+void Effects::clear()
+{
+    m_debris.clear();
+    m_fx.clear();
+}
+
+////////// DRAW
+void Effects::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    target.draw(m_debris, states);
+    target.draw(m_fx, states);
+}
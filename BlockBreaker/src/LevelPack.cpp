@@ -0,0 +1,325 @@
+#include "../include/LevelPack.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+
+const char          MAGIC[4]{'B', 'B', 'L', 'P'};
+const std::uint8_t  VERSION{1};
+const std::size_t   HEADER_SIZE{8};
+
+inline std::uint32_t readU32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+inline std::uint16_t readU16(const std::uint8_t *p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+void putU16(std::string& out, std::uint16_t v)
+{
+    out.push_back(static_cast<char>(v & 0xFF));
+    out.push_back(static_cast<char>(v >> 8));
+}
+
+void putU32(std::string& out, std::uint32_t v)
+{
+    for(int i=0; i<4; ++i)
+        out.push_back(static_cast<char>((v >> (8*i)) & 0xFF));
+}
+
+// Text cell -> block
+bool cellFromChar(char ch, LevelCell& cell)
+{
+    cell = LevelCell{};
+    if(ch == '.' || ch == ' ')
+        return true;
+    if(ch == '#'){
+        cell.type = blockType::NORMAL;
+        cell.hp   = 3;
+    }
+    else if(ch >= '1' && ch <= '9'){
+        cell.type = blockType::NORMAL;
+        cell.hp   = static_cast<std::uint8_t>(ch - '0');
+    }
+    else if(ch == 'H'){
+        cell.type = blockType::HARD;
+        cell.hp   = 6;
+    }
+    else if(ch == 'X'){
+        cell.type = blockType::UNBREAKABLE;
+        cell.hp   = 15;
+    }
+    else{
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+LevelPack::LevelPack() :
+    m_file(),
+    m_textures(),
+    m_index(),
+    m_error()
+{
+
+}
+
+////////// OPEN
+bool LevelPack::open(const std::string& fileName)
+{
+    m_textures.clear();
+    m_index.clear();
+    m_error.clear();
+
+    if(!m_file.open(fileName)){
+        m_error = "can't open " + fileName;
+        return false;
+    }
+
+    const std::uint8_t *data = m_file.data();
+    const std::size_t size{m_file.size()};
+    if(size < HEADER_SIZE || !std::equal(MAGIC, MAGIC + 4, reinterpret_cast<const char*>(data)) || data[4] != VERSION){
+        m_error = fileName + " is not a level pack (or not this version)";
+        return false;
+    }
+
+    const std::size_t nbTextures{data[5]};
+    const std::size_t nbLevels{readU16(data + 6)};
+    std::size_t pos{HEADER_SIZE};
+
+    for(std::size_t t=0; t<nbTextures; ++t){
+        if(pos >= size || pos + 1 + data[pos] > size){
+            m_error = "truncated texture table";
+            return false;
+        }
+        m_textures.emplace_back(reinterpret_cast<const char*>(data + pos + 1), data[pos]);
+        pos += 1 + data[pos];
+    }
+
+    if(pos + (nbLevels * 8) > size){
+        m_error = "truncated level index";
+        return false;
+    }
+    for(std::size_t l=0; l<nbLevels; ++l){
+        const Entry entry{readU32(data + pos), readU32(data + pos + 4)};
+        if(static_cast<std::size_t>(entry.offset) + entry.size > size){
+            m_error = "level " + std::to_string(l) + " is out of the file";
+            return false;
+        }
+        m_index.push_back(entry);
+        pos += 8;
+    }
+
+    return true;
+}
+
+////////// DECODE (only touches this level's pages)
+bool LevelPack::decode(std::size_t index, Level& level) const
+{
+    if(index >= m_index.size())
+        return false;
+
+    const std::uint8_t *p = m_file.data() + m_index[index].offset;
+    const std::uint8_t *end = p + m_index[index].size;
+    if(end - p < 6)
+        return false;
+
+    const std::size_t rows{readU16(p)}, cols{readU16(p + 2)};
+    level.texture = p[4];
+    const std::size_t nameLength{p[5]};
+    p += 6;
+    if(static_cast<std::size_t>(end - p) < nameLength)
+        return false;
+    level.name.assign(reinterpret_cast<const char*>(p), nameLength);
+    p += nameLength;
+
+    level.cells = Matrix<LevelCell>(rows, cols);
+
+    return decodeRuns(p, end, level.cells.data(), level.cells.size()) == level.cells.size();
+}
+
+////////// PARSE TEXT
+bool LevelPack::parseText(std::istream& is, std::vector<Level>& levels,
+                          std::vector<std::string>& textures, std::string& error)
+{
+    std::string line;
+    std::size_t lineNb{0};
+    std::uint8_t texture{0};
+    std::size_t repeat{1};
+    bool inLevel{false};
+    std::vector<std::string> rows;
+    Level current;
+
+    auto fail = [&](const std::string& what){
+        error = "line " + std::to_string(lineNb) + " : " + what;
+        return false;
+    };
+
+    while(std::getline(is, line)){
+        ++lineNb;
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if(!inLevel){
+            if(line.empty() || line[0] == '#')
+                continue;
+            std::istringstream iss(line);
+            std::string keyword;
+            iss >> keyword;
+            if(keyword == "texture"){
+                std::string path;
+                iss >> path;
+                if(path.empty() || path.size() > 255)
+                    return fail("bad texture path");
+                auto it = std::find(textures.begin(), textures.end(), path);
+                if(it == textures.end()){
+                    if(textures.size() >= 255)
+                        return fail("too many textures");
+                    textures.push_back(path);
+                    it = textures.end() - 1;
+                }
+                texture = static_cast<std::uint8_t>(it - textures.begin());
+            }
+            else if(keyword == "repeat"){
+                if(!(iss >> repeat) || repeat == 0)
+                    return fail("bad repeat count");
+            }
+            else if(keyword == "level"){
+                std::getline(iss >> std::ws, current.name);
+                if(current.name.size() > 255)
+                    return fail("level name too long");
+                current.texture = texture;
+                rows.clear();
+                inLevel = true;
+            }
+            else{
+                return fail("unknown keyword '" + keyword + "'");
+            }
+            continue;
+        }
+
+        if(line == "end"){
+            if(rows.empty())
+                return fail("empty level");
+            if(rows.size() * repeat > 0xFFFF)
+                return fail("level too large");
+            current.cells = Matrix<LevelCell>(rows.size() * repeat, rows[0].size());
+            for(std::size_t i=0; i<current.cells.rows(); ++i){
+                const std::string& row = rows[i % rows.size()];
+                if(row.size() != rows[0].size())
+                    return fail("rows of level '" + current.name + "' have different lengths");
+                for(std::size_t j=0; j<row.size(); ++j)
+                    if(!cellFromChar(row[j], current.cells(i, j)))
+                        return fail(std::string("unknown block '") + row[j] + "'");
+            }
+            levels.push_back(current);
+            repeat  = 1;
+            inLevel = false;
+            continue;
+        }
+
+        if(rows.size() >= 0xFFFF || line.size() >= 0xFFFF)
+            return fail("level too large");
+        rows.push_back(line);
+    }
+
+    if(inLevel)
+        return fail("missing 'end'");
+    if(levels.size() > 0xFFFF)
+        return fail("too many levels");
+
+    return true;
+}
+
+////////// WRITE
+bool LevelPack::write(const std::string& fileName, const std::vector<Level>& levels,
+                      const std::vector<std::string>& textures)
+{
+    // Level blobs first, the index needs their sizes
+    std::vector<std::string> blobs;
+    for(const auto& level : levels){
+        std::string blob;
+        putU16(blob, static_cast<std::uint16_t>(level.cells.rows()));
+        putU16(blob, static_cast<std::uint16_t>(level.cells.cols()));
+        blob.push_back(static_cast<char>(level.texture));
+        blob.push_back(static_cast<char>(level.name.size()));
+        blob += level.name;
+
+        // Run length : levels are mostly rows of the same block
+        std::vector<std::uint8_t> runs;
+        encodeRuns(level.cells.data(), level.cells.size(), runs);
+        blob.append(runs.begin(), runs.end());
+        blobs.push_back(blob);
+    }
+
+    std::string out(MAGIC, MAGIC + 4);
+    out.push_back(static_cast<char>(VERSION));
+    out.push_back(static_cast<char>(textures.size()));
+    putU16(out, static_cast<std::uint16_t>(levels.size()));
+    for(const auto& t : textures){
+        out.push_back(static_cast<char>(t.size()));
+        out += t;
+    }
+
+    std::uint32_t offset{static_cast<std::uint32_t>(out.size() + (levels.size() * 8))};
+    for(const auto& blob : blobs){
+        putU32(out, offset);
+        putU32(out, static_cast<std::uint32_t>(blob.size()));
+        offset += static_cast<std::uint32_t>(blob.size());
+    }
+    for(const auto& blob : blobs)
+        out += blob;
+
+    std::ofstream os(fileName, std::ios_base::binary | std::ios_base::trunc);
+    os.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(os);
+}
+
+////////// CELLS
+std::uint8_t LevelPack::packCell(const LevelCell& cell)
+{
+    return static_cast<std::uint8_t>((cell.type << 4) | (cell.hp & 0x0F));
+}
+
+LevelCell LevelPack::unpackCell(std::uint8_t value)
+{
+    LevelCell cell;
+    cell.type = static_cast<std::uint8_t>(value >> 4);
+    cell.hp   = static_cast<std::uint8_t>(value & 0x0F);
+    return cell;
+}
+
+void LevelPack::encodeRuns(const LevelCell *cells, std::size_t count, std::vector<std::uint8_t>& out)
+{
+    std::size_t id{0};
+    while(id < count){
+        const std::uint8_t cell{packCell(cells[id])};
+        std::size_t run{1};
+        while(run < 255 && id + run < count && packCell(cells[id + run]) == cell)
+            ++run;
+        out.push_back(static_cast<std::uint8_t>(run));
+        out.push_back(cell);
+        id += run;
+    }
+}
+
+std::size_t LevelPack::decodeRuns(const std::uint8_t *first, const std::uint8_t *last,
+                                  LevelCell *cells, std::size_t count)
+{
+    std::size_t id{0};
+    while(id < count && last - first >= 2){
+        const std::size_t run{std::min<std::size_t>(first[0], count - id)};
+        std::fill_n(cells + id, run, unpackCell(first[1]));
+        id    += run;
+        first += 2;
+    }
+    return id;
+}
@@ -0,0 +1,137 @@
+#include "../include/ParticlePool.h"
+
+#include <chrono>
+#include <algorithm>
+
+ParticlePool::ParticlePool(std::size_t capacity, const sf::Texture *texture) :
+    m_texture{texture},
+    m_count{0},
+    m_dropped{0},
+    m_x(capacity), m_y(capacity), m_vx(capacity), m_vy(capacity),
+    m_w(capacity), m_h(capacity), m_gravity(capacity),
+    m_life(capacity), m_invMaxLife(capacity),
+    m_u(capacity), m_v(capacity), m_texW(capacity), m_texH(capacity),
+    m_color(capacity),
+    m_vertices(capacity * 4),
+    m_updateMs{0.},
+    m_drawMs{0.}
+{
+
+}
+
+////////// EMIT / CLEAR
+bool ParticlePool::emit(const sf::Vector2f& position, const sf::Vector2f& velocity, const sf::Vector2f& size,
+                        const sf::FloatRect& texRect, const sf::Color& color, float life, float gravity)
+{
+    if(m_count == capacity() || life <= 0.f){
+        ++m_dropped;
+        return false;
+    }
+
+    const std::size_t i{m_count++};
+    m_x[i]          = position.x;
+    m_y[i]          = position.y;
+    m_vx[i]         = velocity.x;
+    m_vy[i]         = velocity.y;
+    m_w[i]          = size.x;
+    m_h[i]          = size.y;
+    m_gravity[i]    = gravity;
+    m_life[i]       = life;
+    m_invMaxLife[i] = 1.f / life;
+    m_u[i]          = texRect.left;
+    m_v[i]          = texRect.top;
+    m_texW[i]       = texRect.width;
+    m_texH[i]       = texRect.height;
+    m_color[i]      = color;
+
+    return true;
+}
+
+void ParticlePool::clear()
+{
+    m_count   = 0;
+    m_dropped = 0;
+}
+
+////////// UPDATE
+void ParticlePool::update(float dt)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // Ageing first, so the loops below only see live particles
+    for(std::size_t i=0; i<m_count; ++i)
+        m_life[i] -= dt;
+    for(std::size_t i=0; i<m_count;){
+        if(m_life[i] <= 0.f)
+            kill(i);
+        else
+            ++i;
+    }
+
+    const std::size_t n{m_count};
+    for(std::size_t i=0; i<n; ++i)
+        m_vy[i] += m_gravity[i] * dt;
+    for(std::size_t i=0; i<n; ++i)
+        m_x[i] += m_vx[i] * dt;
+    for(std::size_t i=0; i<n; ++i)
+        m_y[i] += m_vy[i] * dt;
+
+    updateVertices();
+
+    m_updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Last live particle moves in the hole
+void ParticlePool::kill(std::size_t i)
+{
+    const std::size_t last{--m_count};
+    m_x[i]          = m_x[last];
+    m_y[i]          = m_y[last];
+    m_vx[i]         = m_vx[last];
+    m_vy[i]         = m_vy[last];
+    m_w[i]          = m_w[last];
+    m_h[i]          = m_h[last];
+    m_gravity[i]    = m_gravity[last];
+    m_life[i]       = m_life[last];
+    m_invMaxLife[i] = m_invMaxLife[last];
+    m_u[i]          = m_u[last];
+    m_v[i]          = m_v[last];
+    m_texW[i]       = m_texW[last];
+    m_texH[i]       = m_texH[last];
+    m_color[i]      = m_color[last];
+}
+
+// Centered quads, faded out over their life
+void ParticlePool::updateVertices()
+{
+    for(std::size_t i=0; i<m_count; ++i){
+        const float halfW{m_w[i] / 2.f}, halfH{m_h[i] / 2.f};
+        const float u{m_u[i]}, v{m_v[i]}, tw{m_texW[i]}, th{m_texH[i]};
+        sf::Color color{m_color[i]};
+        color.a = static_cast<sf::Uint8>(color.a * std::min(m_life[i] * m_invMaxLife[i], 1.f));
+
+        sf::Vertex *quad = &m_vertices[i * 4];
+        quad[0].position  = sf::Vector2f{m_x[i] - halfW, m_y[i] - halfH};
+        quad[1].position  = sf::Vector2f{m_x[i] + halfW, m_y[i] - halfH};
+        quad[2].position  = sf::Vector2f{m_x[i] + halfW, m_y[i] + halfH};
+        quad[3].position  = sf::Vector2f{m_x[i] - halfW, m_y[i] + halfH};
+        quad[0].texCoords = sf::Vector2f{u, v};
+        quad[1].texCoords = sf::Vector2f{u + tw, v};
+        quad[2].texCoords = sf::Vector2f{u + tw, v + th};
+        quad[3].texCoords = sf::Vector2f{u, v + th};
+        quad[0].color = quad[1].color = quad[2].color = quad[3].color = color;
+    }
+}
+
+////////// DRAW
+void ParticlePool::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    if(m_count > 0){
+        states.texture = m_texture;
+        target.draw(m_vertices.data(), m_count * 4, sf::Quads, states);
+    }
+
+    m_drawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////
+/////// LEVEL PACKER
+// Converts text levels into the level pack read by the game.
+// Build : g++ -std=c++1z -O2 -pthread LevelPacker.cpp ../src/LevelPack.cpp -o LevelPacker
+// Usage : LevelPacker levels/levels.txt assets/levels.pak   (from BlockBreaker/)
+
+#include <iostream>
+#include <fstream>
+
+#include "../include/LevelPack.h"
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3){
+        std::cout << "Usage : " << argv[0] << " <levels.txt> <out.pak>\n";
+        return 1;
+    }
+
+    std::ifstream is(argv[1]);
+    if(!is){
+        std::cout << "Can't read " << argv[1] << '\n';
+        return 1;
+    }
+
+    std::vector<Level> levels;
+    std::vector<std::string> textures;
+    std::string error;
+    if(!LevelPack::parseText(is, levels, textures, error)){
+        std::cout << argv[1] << ", " << error << '\n';
+        return 1;
+    }
+
+    if(!LevelPack::write(argv[2], levels, textures)){
+        std::cout << "Can't write " << argv[2] << '\n';
+        return 1;
+    }
+
+    // Read it back : the game must see the same levels
+    LevelPack pack;
+    if(!pack.open(argv[2])){
+        std::cout << "Written pack doesn't open : " << pack.getError() << '\n';
+        return 1;
+    }
+    std::size_t blocks{0};
+    for(std::size_t i=0; i<pack.count(); ++i){
+        Level level;
+        if(!pack.decode(i, level)){
+            std::cout << "Level " << i << " doesn't decode back\n";
+            return 1;
+        }
+        for(std::size_t id=0; id<level.cells.size(); ++id)
+            if(level.cells[id].type != levels[i].cells[id].type || level.cells[id].hp != levels[i].cells[id].hp){
+                std::cout << "Level " << i << " differs after packing\n";
+                return 1;
+            }
+        blocks += level.cells.size();
+        std::cout << "  " << i << " : " << level.name << " (" << level.cells.rows() << 'x' << level.cells.cols()
+                  << ", " << textures[level.texture] << ")\n";
+    }
+
+    std::ifstream size(argv[2], std::ios_base::binary | std::ios_base::ate);
+    std::cout << pack.count() << " level(s), " << textures.size() << " texture(s), "
+              << blocks << " cells in " << size.tellg() << " bytes -> " << argv[2] << '\n';
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef CELLAGE_H
+#define CELLAGE_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <SFML/Graphics.hpp>
+
+#include "../../Utilities/Matrix.hpp"
+
+// Per-cell age and activity heat, kept out of Cell in flat byte arrays
+// so the per-generation update is a couple of saturating SIMD ops
+// (64-byte aligned Matrix storage, row-major like the cell ids). SSE2
+// when the compiler targets it, a scalar loop otherwise.
+class CellAge : public sf::Drawable
+{
+public:
+    enum Mode{
+        NONE,
+        AGE,
+        HEAT,
+        MODE_MAX
+    };
+
+    CellAge() = delete;
+    CellAge(unsigned nb_rows, unsigned nb_cols, unsigned tile_width, unsigned tile_height);
+
+    CellAge(const CellAge&) = delete;
+    CellAge& operator=(const CellAge&) = delete;
+    CellAge(CellAge&&) = default;
+    CellAge& operator=(CellAge&&) = default;
+
+    ~CellAge() = default;
+
+    inline bool isEnabled() const { return m_mode != Mode::NONE; }
+    inline Mode getMode() const { return m_mode; }
+    void nextMode();
+
+    // Alive mask of the generation just applied (0x00 dead, 0xFF alive)
+    inline void setAlive(std::size_t cellId, bool alive) { m_alive[cellId] = alive ? 0xFF : 0x00; }
+    void setCell(std::size_t cellId, bool alive);
+    void step();
+    void reset();
+    void updateColors();
+
+private:
+    Mode                        m_mode;
+    std::uint8_t                m_heatDecay;
+    bool                        m_dirty;
+    Matrix<std::uint8_t>        m_alive;
+    Matrix<std::uint8_t>        m_age;
+    Matrix<std::uint8_t>        m_heat;
+    std::array<sf::Color, 256>  m_agePalette;
+    std::array<sf::Color, 256>  m_heatPalette;
+    sf::VertexArray             m_vertices;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+};
+
+#endif // CELLAGE_H
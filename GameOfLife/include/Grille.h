@@ -9,7 +9,8 @@
 #include <SFML/Graphics.hpp>
 
 #include "Cell.h"
-#include "Outils.h"
+#include "CellAge.h"
+#include "../../Utilities/Matrix.hpp"
 
 class Grille : public sf::Drawable
 {
@@ -36,6 +37,7 @@ public:
 	void switchCellByClick();
 	void genereRandCells();
 	void resetLife();
+	void nextAgeMode();
 
 	void update(bool activeAutomata, const sf::Time& dt);
 
@@ -54,13 +56,16 @@ private:
 	// All container's elements are shared_ptr
 	VectorRects             m_rects;
 	VectorCells             m_cells;
+	// Alive snapshot of the generation being computed (bit-packed)
+	Matrix<bool>            m_alive;
+	CellAge                 m_cellAge;
 
 	// Func
 	void updateCellState();
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 	void mouseCurrentIndex();
 	std::size_t searchIndexByPosition(float pos_x, float pos_y) const;
-	std::size_t getAliveNeighbourhood(std::size_t cellId) const;
+	std::size_t getAliveNeighbourhood(unsigned row, unsigned col) const;
 
 /////// INLINE MEMBERS
 
@@ -0,0 +1,57 @@
+#ifndef SHARDEDLIFE_H
+#define SHARDEDLIFE_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Headless Life split in horizontal shards, one process per shard.
+// Shards share a POSIX shared-memory region holding the halo rows
+// and a process-shared barrier (one wait per generation).
+// POSIX only (link with -pthread, and -lrt on older glibc).
+class ShardedLife
+{
+public:
+    struct ShardStats
+    {
+        unsigned      firstRow;
+        unsigned      nbRows;
+        double        exchangeMs; // publish halos + barrier wait + read halos
+        double        stepMs;     // compute only
+        std::uint64_t population; // alive cells after the last generation
+    };
+
+    ShardedLife() = delete;
+    ShardedLife(
+        unsigned nb_rows,
+        unsigned nb_cols,
+        unsigned nb_shards,
+        unsigned nb_generations,
+        std::uint32_t seed = 0
+    );
+
+    ShardedLife(const ShardedLife&) = delete;
+    ShardedLife& operator=(const ShardedLife&) = delete;
+
+    ~ShardedLife() = default;
+
+    static bool isSupported();
+
+    bool run();
+    void printReport(std::ostream& os) const;
+    inline const std::vector<ShardStats>& getStats() const { return m_stats; }
+    inline const std::string& getError() const { return m_error; }
+
+private:
+    const unsigned          m_rows;
+    const unsigned          m_cols;
+    const unsigned          m_shards;
+    const unsigned          m_generations;
+    const std::uint32_t     m_seed;
+    double                  m_wallMs;
+    std::vector<ShardStats> m_stats;
+    std::string             m_error;
+};
+
+#endif // SHARDEDLIFE_H
@@ -1,14 +1,92 @@
 #include <iostream>
+#include <string>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 
-#include "include/Outils.h"
 #include "include/Grille.h"
+#include "include/ShardedLife.h"
+#include "../Utilities/Hud.hpp"
+#include "../Utilities/Random.hpp"
+#include "../Utilities/GameLoop.hpp"
+#include "../Utilities/Arguments.hpp"
+#define ASSETLOADER_NO_AUDIO
+#include "../Utilities/AssetLoader.hpp"
 
 ///////////////////////////////
-int main()
+/////// HEADLESS SHARDED MODE
+// GameOfLife --shards N [--rows R] [--cols C] [--gens G] [--seed S]
+bool isSharded(int argc, char *argv[])
 {
+    for(int i=1; i<argc; ++i)
+        if(std::string(argv[i]) == "--shards")
+            return true;
+    return false;
+}
+
+int shardedUsage(const char *program)
+{
+    std::cout << "Usage : " << program << " --shards N [--rows R] [--cols C] [--gens G] [--seed S]" << '\n';
+    return 1;
+}
+
+int runSharded(int argc, char *argv[])
+{
+    unsigned shards{1}, rows{4096}, cols{4096}, gens{200}, seed{0};
+
+    for(int i=1; i<argc; i+=2){
+        const std::string arg{argv[i]};
+        if(i+1 >= argc){
+            std::cout << "Missing value for " << arg << '\n';
+            return shardedUsage(argv[0]);
+        }
+        unsigned value{0};
+        if(!Arguments::parse(argv[i+1], value)){
+            std::cout << "Bad value '" << argv[i+1] << "' for " << arg << '\n';
+            return shardedUsage(argv[0]);
+        }
+        if(arg == "--shards")    shards = value;
+        else if(arg == "--rows") rows = value;
+        else if(arg == "--cols") cols = value;
+        else if(arg == "--gens") gens = value;
+        else if(arg == "--seed") seed = value;
+        else {
+            std::cout << "Unknown option " << arg << '\n';
+            return shardedUsage(argv[0]);
+        }
+    }
+    if(shards == 0 || rows == 0 || cols == 0){
+        std::cout << "Shards, rows and cols must be at least 1" << '\n';
+        return shardedUsage(argv[0]);
+    }
+
+    if(!ShardedLife::isSupported()){
+        std::cout << "Sharded mode is not supported on this platform" << '\n';
+        return 1;
+    }
+
+    ShardedLife life(rows, cols, shards, gens, seed);
+    if(!life.run()){
+        std::cout << "Sharded run failed : " << life.getError() << '\n';
+        return 1;
+    }
+    life.printReport(std::cout);
+
+    return 0;
+}
+
+///////////////////////////////
+int main(int argc, char *argv[])
+{
+    if(isSharded(argc, argv))
+        return runSharded(argc, argv);
+
+    /////// ASSETS (archive, or loose files without it)
+    sf::Clock startup;
+    AssetLoader assets;
+    if(!assets.open("assets.pak"))
+        std::cout << "No asset archive (" << assets.getError() << "), loose files\n";
+
     sf::RenderWindow window(sf::VideoMode(1024, 576), "Sans Titre", sf::Style::Close);
 
     /////// GRILLE
@@ -17,26 +95,27 @@ int main()
     grid.fillWithCell();
 
     /////// FPS TEXT
-    sf::Font font;
-    font.loadFromFile("arial.ttf");
-    sf::Text fpsText("", font, 16);
-    fpsText.setPosition(10,10);
-    fpsText.setFillColor(sf::Color::Green);
+    AssetLoader::FontHandle font{assets.getFont("arial.ttf")};
+    if(!font){
+        std::cout << "Assets : " << assets.getError() << '\n';
+        font = std::make_shared<sf::Font>();
+    }
+    Hud hud;
+    hud.load(*font, 16);
+    const std::size_t hudFps{hud.addCounter(sf::Vector2f(10.f, 10.f), Hud::LEFT, 5, sf::Color::Green)};
+
+    assets.printStats(std::cout);
+    std::cout << "Startup : " << startup.getElapsedTime().asMilliseconds() << " ms\n";
 
     /////// VARS
-    sf::Clock clock;
-    sf::Time dt;
-    float fps;
-    float elapsed{0};
     bool AUTOMATA{false};
     sf::Color backgroundColor(sf::Color(61,61,61));
 
-    /////// GAME LOOP
+    /////// GAME LOOP (60 steps/s, 60 fps at most)
+    GameLoop loop(1.f / 60.f, 60);
     while (window.isOpen())
     {
-        dt = clock.restart();
-        elapsed += dt.asSeconds();
-        fps = 1 / dt.asSeconds();
+        loop.beginFrame();
 
         /////// EVENTS
         sf::Event event;
@@ -57,6 +136,9 @@ int main()
                     std::cout << "STATES reset and AUTOMATA desactived" << '\n';
                     grid.resetLife();
                 }
+                if(event.key.code == sf::Keyboard::A) {
+                    grid.nextAgeMode();
+                }
                 if(event.key.code == sf::Keyboard::R) {
                     if(!AUTOMATA)
                         grid.genereRandCells();
@@ -78,9 +160,9 @@ int main()
                     grid.switchCellByClick();
                 }
                 if(event.mouseButton.button == sf::Mouse::Right) {
-                    backgroundColor = sf::Color(Outils::rollTheDice(0,255),
-                                                Outils::rollTheDice(0,255),
-                                                Outils::rollTheDice(0,255));
+                    backgroundColor = sf::Color(Random::between(0,255),
+                                                Random::between(0,255),
+                                                Random::between(0,255));
                 }
             }
 
@@ -89,14 +171,17 @@ int main()
         }
 
         /////// UPDATE
-        grid.update(AUTOMATA, dt);
-        fpsText.setString(std::to_string(static_cast<unsigned>(fps)));
+        while(loop.step())
+            grid.update(AUTOMATA, sf::seconds(loop.getStep()));
+        hud.set(hudFps, static_cast<long>(loop.getStats().fps + 0.5f));
 
         /////// DRAW
         window.clear(backgroundColor);
         window.draw(grid);
-        window.draw(fpsText);
+        window.draw(hud);
         window.display();
+
+        loop.endFrame(window.hasFocus());
     }
 
     return 0;
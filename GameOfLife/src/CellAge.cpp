@@ -0,0 +1,151 @@
+#include "../include/CellAge.h"
+
+#include <algorithm>
+
+// 32-bit MinGW only defines __SSE2__ with -msse2 (set in the .cbp) ;
+// without it, the scalar loop does the update
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CELLAGE_SSE2
+#endif
+
+namespace {
+
+sf::Color lerpColor(const sf::Color& a, const sf::Color& b, float t)
+{
+    return sf::Color(static_cast<sf::Uint8>(a.r + (b.r - a.r) * t),
+                     static_cast<sf::Uint8>(a.g + (b.g - a.g) * t),
+                     static_cast<sf::Uint8>(a.b + (b.b - a.b) * t),
+                     static_cast<sf::Uint8>(a.a + (b.a - a.a) * t));
+}
+
+} // namespace
+
+CellAge::CellAge(unsigned nb_rows, unsigned nb_cols, unsigned tile_width, unsigned tile_height) :
+    m_mode{Mode::NONE},
+    m_heatDecay{8},
+    m_dirty{false},
+    m_alive(nb_rows, nb_cols, 0),
+    m_age(nb_rows, nb_cols, 0),
+    m_heat(nb_rows, nb_cols, 0),
+    m_vertices(sf::Quads, nb_rows * nb_cols * 4)
+{
+    // AGE : newborn white -> yellow -> red -> deep purple for the elders
+    m_agePalette[0] = sf::Color::Transparent;
+    for(std::size_t i=1; i<m_agePalette.size(); ++i){
+        const float t{std::min(1.f, static_cast<float>(i) / 64.f)};
+        m_agePalette[i] = (t < 0.5f) ?
+            lerpColor(sf::Color(255, 255, 255), sf::Color(255, 200, 0), t * 2.f) :
+                lerpColor(sf::Color(255, 200, 0), sf::Color(120, 0, 90), (t - 0.5f) * 2.f);
+    }
+
+    // HEAT : black body ramp, fading out as activity decays
+    m_heatPalette[0] = sf::Color::Transparent;
+    for(std::size_t i=1; i<m_heatPalette.size(); ++i){
+        const float t{static_cast<float>(i) / 255.f};
+        sf::Color c = (t < 0.5f) ?
+            lerpColor(sf::Color(60, 0, 0), sf::Color(255, 60, 0), t * 2.f) :
+                lerpColor(sf::Color(255, 60, 0), sf::Color(255, 255, 200), (t - 0.5f) * 2.f);
+        c.a = static_cast<sf::Uint8>(40 + 215 * t);
+        m_heatPalette[i] = c;
+    }
+
+    std::size_t v{0};
+    for(unsigned i=0; i<nb_rows; ++i){
+        for(unsigned j=0; j<nb_cols; ++j){
+            const float x{static_cast<float>(j * tile_width)};
+            const float y{static_cast<float>(i * tile_height)};
+            m_vertices[v++].position = sf::Vector2f(x, y);
+            m_vertices[v++].position = sf::Vector2f(x + tile_width, y);
+            m_vertices[v++].position = sf::Vector2f(x + tile_width, y + tile_height);
+            m_vertices[v++].position = sf::Vector2f(x, y + tile_height);
+        }
+    }
+}
+
+////////// NEXT MODE
+void CellAge::nextMode()
+{
+    m_mode = static_cast<Mode>((m_mode + 1) % Mode::MODE_MAX);
+    m_dirty = true;
+}
+
+////////// SET CELL (edited by hand, outside a generation)
+void CellAge::setCell(std::size_t cellId, bool alive)
+{
+    setAlive(cellId, alive);
+    m_age[cellId]  = alive ? 1 : 0;
+    m_heat[cellId] = alive ? 0xFF : m_heat[cellId];
+    m_dirty = true;
+}
+
+////////// STEP
+// age  = alive ? min(age + 1, 255) : 0
+// heat = alive ? 255 : max(heat - decay, 0)
+void CellAge::step()
+{
+    const std::size_t size{m_alive.size()};
+    const std::uint8_t *alive = m_alive.data();
+    std::uint8_t *age  = m_age.data();
+    std::uint8_t *heat = m_heat.data();
+    std::size_t i{0};
+
+#ifdef CELLAGE_SSE2
+    const __m128i one   = _mm_set1_epi8(1);
+    const __m128i decay = _mm_set1_epi8(static_cast<char>(m_heatDecay));
+
+    for(; i+16<=size; i+=16){
+        const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alive + i));
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(age + i));
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(heat + i));
+        a = _mm_and_si128(_mm_adds_epu8(a, one), mask);
+        h = _mm_max_epu8(_mm_subs_epu8(h, decay), mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(age + i), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(heat + i), h);
+    }
+#endif
+
+    for(; i<size; ++i){
+        const std::uint8_t a = static_cast<std::uint8_t>(age[i] + (age[i] != 0xFF));
+        const std::uint8_t h = static_cast<std::uint8_t>((heat[i] > m_heatDecay) ? heat[i] - m_heatDecay : 0);
+        age[i]  = a & alive[i];
+        heat[i] = h | alive[i];
+    }
+
+    m_dirty = true;
+}
+
+////////// RESET
+void CellAge::reset()
+{
+    m_alive.fill(0);
+    m_age.fill(0);
+    m_heat.fill(0);
+    m_dirty = true;
+}
+
+////////// UPDATE COLORS
+void CellAge::updateColors()
+{
+    if(!m_dirty || !isEnabled())
+        return;
+
+    const Matrix<std::uint8_t>& values = (m_mode == Mode::AGE) ? m_age : m_heat;
+    const std::array<sf::Color, 256>& palette = (m_mode == Mode::AGE) ? m_agePalette : m_heatPalette;
+
+    for(std::size_t i=0; i<values.size(); ++i){
+        const sf::Color& c = palette[values[i]];
+        m_vertices[(i*4)].color   = c;
+        m_vertices[(i*4)+1].color = c;
+        m_vertices[(i*4)+2].color = c;
+        m_vertices[(i*4)+3].color = c;
+    }
+
+    m_dirty = false;
+}
+
+////////// DRAW
+void CellAge::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    target.draw(m_vertices, states);
+}
@@ -1,4 +1,5 @@
 #include "../include/Grille.h"
+#include "../../Utilities/Random.hpp"
 
 Grille::Grille(
     sf::RenderWindow *window,
@@ -16,7 +17,9 @@ Grille::Grille(
     m_mouseCurrIndex{0},
     m_elapsed{0},
     m_rects(std::vector<std::unique_ptr<sf::RectangleShape>>()),
-    m_cells(std::vector<std::unique_ptr<Cell>>())
+    m_cells(std::vector<std::unique_ptr<Cell>>()),
+    m_alive(nb_rows, nb_cols, false),
+    m_cellAge(nb_rows, nb_cols, tile_width, tile_height)
 {
 
 }
@@ -67,6 +70,9 @@ void Grille::switchCellByClick()
     (m_cells[m_mouseCurrIndex]->isAlive()) ?
         m_cells[m_mouseCurrIndex]->setAlive(false) :
             m_cells[m_mouseCurrIndex]->setAlive(true);
+
+    if(m_cellAge.isEnabled())
+        m_cellAge.setCell(m_mouseCurrIndex, m_cells[m_mouseCurrIndex]->isAlive());
 }
 
 ////////// RESET LIFE
@@ -76,15 +82,36 @@ void Grille::resetLife()
         x->setAlive(false);
         x->setNextState(false);
     }
+    m_cellAge.reset();
+}
+
+////////// NEXT AGE MODE (none -> age -> heat)
+void Grille::nextAgeMode()
+{
+    const bool wasEnabled{m_cellAge.isEnabled()};
+    m_cellAge.nextMode();
+
+    // Ages aren't tracked while disabled : restart from the current cells
+    if(!wasEnabled && m_cellAge.isEnabled()){
+        m_cellAge.reset();
+        for(std::size_t id=0; id<m_cells.size(); ++id)
+            m_cellAge.setCell(id, m_cells[id]->isAlive());
+    }
 }
 
 ////////// GENERE RAND
 void Grille::genereRandCells()
 {
     resetLife();
+    // One random number for 64 cells
+    std::vector<std::uint8_t> dice(m_cells.size());
+    Random::local().fillCoins(dice.data(), dice.size());
+    std::size_t id{0};
     for(auto&& x : m_cells) {
-        bool dice = static_cast<bool>(Outils::rollTheDice(0, 1));
-        x->setAlive(dice);
+        x->setAlive(dice[id] != 0);
+        if(m_cellAge.isEnabled())
+            m_cellAge.setCell(id, dice[id] != 0);
+        ++id;
     }
 }
 
@@ -110,23 +137,17 @@ void Grille::mouseCurrentIndex()
 }
 
 ////////// GET ALIVE NEIGHGBOURHOOD
-std::size_t Grille::getAliveNeighbourhood(std::size_t cellId) const
+// Cells outside the grid count as dead (no wrap to the previous/next row)
+std::size_t Grille::getAliveNeighbourhood(unsigned row, unsigned col) const
 {
-    std::vector<std::size_t> tmp_id;
-    tmp_id.push_back((cellId - 1) - m_cols); // topLeft
-    tmp_id.push_back(cellId - m_cols); // top
-    tmp_id.push_back((cellId + 1) - m_cols); // topRight
-    tmp_id.push_back(cellId - 1); // left
-    tmp_id.push_back(cellId + 1); // right
-    tmp_id.push_back((cellId - 1) + m_cols); // bottomLeft
-    tmp_id.push_back(cellId + m_cols); // bottom
-    tmp_id.push_back((cellId + 1) + m_cols); // bottomRight
-
     std::size_t nb_neighbour{0};
+    const long r{static_cast<long>(row)}, c{static_cast<long>(col)};
 
-    for(const auto& x : tmp_id) {
-        if(x >= 0 && x <= m_cells.size()-1 && m_cells[x]->isAlive())
-            ++nb_neighbour;
+    for(long i = r - 1; i <= r + 1; ++i) {
+        for(long j = c - 1; j <= c + 1; ++j) {
+            if((i != r || j != c) && m_alive.contains(i, j) && m_alive(i, j))
+                ++nb_neighbour;
+        }
     }
 
     return nb_neighbour;
@@ -135,24 +156,43 @@ std::size_t Grille::getAliveNeighbourhood(std::size_t cellId) const
 ////////// UPDATE NEIGHBOURHOOD
 void Grille::updateCellState()
 {
-    int index{0};
-
-    for(auto&& x : m_cells){
-        std::size_t nb_around_live{getAliveNeighbourhood(index)};
-        if(x->isAlive()){
-            (nb_around_live == 2 || nb_around_live == 3) ?
-                x->setNextState(true) : x->setNextState(false);
-        }
-        else {
-            if(nb_around_live == 3)
-                x->setNextState(true);
+    if(m_cells.empty())
+        return;
+
+    // Snapshot first : every cell reads the same generation
+    std::size_t index{0};
+    for(unsigned i = 0; i < m_rows; ++i)
+        for(unsigned j = 0; j < m_cols; ++j)
+            m_alive.set(i, j, m_cells[index++]->isAlive());
+
+    index = 0;
+    for(unsigned i = 0; i < m_rows; ++i) {
+        for(unsigned j = 0; j < m_cols; ++j) {
+            auto&& x = m_cells[index++];
+            std::size_t nb_around_live{getAliveNeighbourhood(i, j)};
+            if(x->isAlive()){
+                (nb_around_live == 2 || nb_around_live == 3) ?
+                    x->setNextState(true) : x->setNextState(false);
+            }
+            else {
+                if(nb_around_live == 3)
+                    x->setNextState(true);
+            }
         }
-        ++index;
     }
 
+    const bool trackAge{m_cellAge.isEnabled()};
+    std::size_t id{0};
+
     for(auto&& x : m_cells){
         x->applyNextState();
+        if(trackAge)
+            m_cellAge.setAlive(id, x->isAlive());
+        ++id;
     }
+
+    if(trackAge)
+        m_cellAge.step();
 }
 
 ////////// UPDATE
@@ -169,13 +209,20 @@ void Grille::update(bool activeAutomata, const sf::Time& dt)
         for(auto&& x : m_cells)
             x->update();
 	}
+
+	m_cellAge.updateColors();
 }
 
 ////////// DRAW
 void Grille::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
-    for(const auto& x :m_cells)
-        target.draw(*x);
+    if(m_cellAge.isEnabled()){
+        target.draw(m_cellAge);
+    }
+    else{
+        for(const auto& x :m_cells)
+            target.draw(*x);
+    }
 
     for (const auto& x : m_rects)
         target.draw(*x);
@@ -0,0 +1,302 @@
+#include "../include/ShardedLife.h"
+#include "../../Utilities/Random.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define SHARDEDLIFE_POSIX
+    #include <pthread.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/wait.h>
+    #include <signal.h>
+    #include <cerrno>
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+inline double elapsedMs(const Clock::time_point& start, const Clock::time_point& end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+#ifdef SHARDEDLIFE_POSIX
+////////// SHARED REGION LAYOUT
+// [Header][ShardStats x shards][halo slots : shards x 2 parities x (top, bottom) x cols]
+// Halo slots are double-buffered by generation parity so a single barrier
+// per generation is enough : nobody rewrites a slot before its neighbour read it.
+struct Header
+{
+    pthread_barrier_t barrier;
+    int               failed;
+};
+
+inline std::size_t statsOffset()
+{
+    return (sizeof(Header) + 63) & ~std::size_t(63);
+}
+
+inline std::size_t slotsOffset(unsigned shards)
+{
+    return (statsOffset() + shards * sizeof(ShardedLife::ShardStats) + 63) & ~std::size_t(63);
+}
+
+inline std::size_t regionSize(unsigned shards, unsigned cols)
+{
+    return slotsOffset(shards) + std::size_t(shards) * 4 * cols;
+}
+
+inline std::uint8_t* haloSlot(unsigned char* base, unsigned shards, unsigned cols,
+                              unsigned shard, unsigned parity, bool bottom)
+{
+    return base + slotsOffset(shards) + ((std::size_t(shard) * 4) + (parity * 2) + (bottom ? 1 : 0)) * cols;
+}
+
+////////// STEP ONE SHARD
+// Rows are padded with one dead column on each side and one halo row
+// above and below, so the inner loop has no branch and vectorises.
+void stepRows(const std::vector<std::uint8_t>& curr, std::vector<std::uint8_t>& next,
+              unsigned nbRows, unsigned cols)
+{
+    const std::size_t stride{cols + 2u};
+
+    for(unsigned i=1; i<=nbRows; ++i){
+        const std::uint8_t *up   = &curr[(i-1)*stride];
+        const std::uint8_t *mid  = &curr[i*stride];
+        const std::uint8_t *down = &curr[(i+1)*stride];
+        std::uint8_t       *out  = &next[i*stride];
+
+        for(std::size_t j=1; j<=cols; ++j){
+            const unsigned n = up[j-1] + up[j] + up[j+1] +
+                               mid[j-1] +        mid[j+1] +
+                               down[j-1] + down[j] + down[j+1];
+            out[j] = static_cast<std::uint8_t>((n == 3) | ((n == 2) & mid[j]));
+        }
+    }
+}
+
+////////// SHARD PROCESS
+void runShard(unsigned char* base, unsigned shard, unsigned shards,
+              unsigned rows, unsigned cols, unsigned generations, std::uint32_t seed)
+{
+    Header *header = reinterpret_cast<Header*>(base);
+    ShardedLife::ShardStats *stats = reinterpret_cast<ShardedLife::ShardStats*>(base + statsOffset()) + shard;
+
+    const unsigned firstRow{static_cast<unsigned>((std::uint64_t(rows) * shard) / shards)};
+    const unsigned lastRow{static_cast<unsigned>((std::uint64_t(rows) * (shard+1)) / shards)};
+    const unsigned nbRows{lastRow - firstRow};
+    const std::size_t stride{cols + 2u};
+
+    std::vector<std::uint8_t> curr((nbRows+2) * stride, 0);
+    std::vector<std::uint8_t> next((nbRows+2) * stride, 0);
+
+    // Each shard seeds its own rows from its stream of the seed : the
+    // result only depends on (seed, shard count)
+    Random::Generator generator{seed, shard};
+    for(unsigned i=1; i<=nbRows; ++i)
+        generator.fillCoins(&curr[i*stride+1], cols);
+
+    double exchangeMs{0}, stepMs{0};
+
+    for(unsigned gen=0; gen<generations; ++gen){
+        const unsigned parity{gen & 1u};
+
+        /////// EXCHANGE HALOS
+        const Clock::time_point t0{Clock::now()};
+
+        std::copy_n(&curr[1*stride+1], cols, haloSlot(base, shards, cols, shard, parity, false));
+        std::copy_n(&curr[nbRows*stride+1], cols, haloSlot(base, shards, cols, shard, parity, true));
+
+        pthread_barrier_wait(&header->barrier);
+
+        if(shard > 0)
+            std::copy_n(haloSlot(base, shards, cols, shard-1, parity, true), cols, &curr[1]);
+        if(shard+1 < shards)
+            std::copy_n(haloSlot(base, shards, cols, shard+1, parity, false), cols, &curr[(nbRows+1)*stride+1]);
+
+        /////// STEP
+        const Clock::time_point t1{Clock::now()};
+        stepRows(curr, next, nbRows, cols);
+        curr.swap(next);
+        const Clock::time_point t2{Clock::now()};
+
+        exchangeMs += elapsedMs(t0, t1);
+        stepMs     += elapsedMs(t1, t2);
+    }
+
+    std::uint64_t population{0};
+    for(unsigned i=1; i<=nbRows; ++i)
+        for(unsigned j=1; j<=cols; ++j)
+            population += curr[i*stride+j];
+
+    stats->firstRow   = firstRow;
+    stats->nbRows     = nbRows;
+    stats->exchangeMs = exchangeMs;
+    stats->stepMs     = stepMs;
+    stats->population = population;
+}
+#endif // SHARDEDLIFE_POSIX
+
+} // namespace
+
+ShardedLife::ShardedLife(
+    unsigned nb_rows,
+    unsigned nb_cols,
+    unsigned nb_shards,
+    unsigned nb_generations,
+    std::uint32_t seed
+) :
+    m_rows{nb_rows},
+    m_cols{nb_cols},
+    m_shards{std::max(1u, std::min(nb_shards, nb_rows))},
+    m_generations{nb_generations},
+    m_seed{seed},
+    m_wallMs{0},
+    m_stats(),
+    m_error()
+{
+
+}
+
+////////// IS SUPPORTED
+bool ShardedLife::isSupported()
+{
+#ifdef SHARDEDLIFE_POSIX
+    return true;
+#else
+    return false;
+#endif
+}
+
+////////// RUN
+bool ShardedLife::run()
+{
+    m_stats.clear();
+    m_error.clear();
+
+#ifdef SHARDEDLIFE_POSIX
+    const std::string name{"/classics_life_" + std::to_string(getpid())};
+    const std::size_t size{regionSize(m_shards, m_cols)};
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0){
+        m_error = "shm_open failed";
+        return false;
+    }
+    if(ftruncate(fd, static_cast<off_t>(size)) != 0){
+        m_error = "ftruncate failed";
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED){
+        m_error = "mmap failed";
+        shm_unlink(name.c_str());
+        return false;
+    }
+    unsigned char *base = static_cast<unsigned char*>(mapped);
+    std::fill_n(base, size, 0);
+
+    Header *header = reinterpret_cast<Header*>(base);
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&header->barrier, &attr, m_shards);
+    pthread_barrierattr_destroy(&attr);
+
+    const Clock::time_point start{Clock::now()};
+
+    std::vector<pid_t> children;
+    for(unsigned s=0; s<m_shards; ++s){
+        pid_t pid = fork();
+        if(pid == 0){
+            runShard(base, s, m_shards, m_rows, m_cols, m_generations, m_seed);
+            _exit(0);
+        }
+        if(pid < 0){
+            // Barrier can't be released without every shard : stop everything
+            header->failed = 1;
+            for(auto child : children)
+                kill(child, SIGKILL);
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    // Reaped in exit order : a shard that dies leaves the others stuck on
+    // the barrier, so the first failure kills the rest
+    std::size_t running{children.size()};
+    while(running > 0){
+        int status{0};
+        const pid_t pid = waitpid(-1, &status, 0);
+        if(pid < 0){
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+        const auto it = std::find(children.begin(), children.end(), pid);
+        if(it == children.end())
+            continue;
+        *it = 0;
+        --running;
+        if((!WIFEXITED(status) || WEXITSTATUS(status) != 0) && header->failed == 0){
+            header->failed = 1;
+            for(auto child : children)
+                if(child != 0)
+                    kill(child, SIGKILL);
+        }
+    }
+
+    m_wallMs = elapsedMs(start, Clock::now());
+
+    const bool ok{header->failed == 0};
+    if(ok){
+        const ShardStats *stats = reinterpret_cast<const ShardStats*>(base + statsOffset());
+        m_stats.assign(stats, stats + m_shards);
+    }
+    else{
+        m_error = "a shard process failed";
+    }
+
+    pthread_barrier_destroy(&header->barrier);
+    munmap(mapped, size);
+    shm_unlink(name.c_str());
+
+    return ok;
+#else
+    m_error = "sharded mode needs POSIX shared memory";
+    return false;
+#endif
+}
+
+////////// PRINT REPORT
+void ShardedLife::printReport(std::ostream& os) const
+{
+    os << "Grid " << m_rows << 'x' << m_cols << ", " << m_shards << " shard(s), "
+       << m_generations << " generation(s), " << std::fixed << std::setprecision(1)
+       << m_wallMs << " ms wall\n";
+    os << "shard   rows          exchange(ms)   step(ms)   exch/step   population\n";
+
+    std::uint64_t population{0};
+    for(std::size_t s=0; s<m_stats.size(); ++s){
+        const ShardStats& st = m_stats[s];
+        const double ratio{(st.stepMs > 0) ? st.exchangeMs / st.stepMs : 0};
+        os << std::setw(5) << s << "   "
+           << std::setw(6) << st.firstRow << '-' << std::left << std::setw(6) << (st.firstRow + st.nbRows) << std::right
+           << std::setw(14) << st.exchangeMs
+           << std::setw(11) << st.stepMs
+           << std::setw(12) << std::setprecision(2) << ratio << std::setprecision(1)
+           << std::setw(13) << st.population
+           << ((ratio > 1.0) ? "   <- exchange bound" : "") << '\n';
+        population += st.population;
+    }
+
+    os << "Total population : " << population << '\n';
+}
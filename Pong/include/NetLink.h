@@ -0,0 +1,66 @@
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <SFML/Network.hpp>
+
+//////////////////////////////////////////////////////////
+/////// NET LINK
+// Non-blocking UDP socket to one peer, with an optional bad network in
+// front of it : outgoing datagrams are dropped with a given probability
+// and held back for latency (+ jitter) before going out, so two games on
+// the same machine play like two games far apart. Times are in seconds,
+// from any clock : flush() sends what is due at 'now'.
+class NetLink
+{
+public:
+    struct Config
+    {
+        unsigned short localPort{0};
+        sf::IpAddress  peer{sf::IpAddress::LocalHost};
+        unsigned short peerPort{0};
+        float          latencyMs{0.f};     // one way
+        float          jitterMs{0.f};      // added to the latency, uniform in [0, jitter]
+        float          lossPercent{0.f};
+        std::uint64_t  seed{1};            // loss and jitter draws
+    };
+
+    NetLink();
+
+    NetLink(const NetLink&) = delete;
+    NetLink& operator=(const NetLink&) = delete;
+
+    bool open(const Config& config);
+
+    void send(const std::vector<std::uint8_t>& datagram, double now);
+    void flush(double now);
+    // Next datagram from the peer, false if there is none yet
+    bool receive(std::vector<std::uint8_t>& datagram);
+
+    ////////// STATS
+    inline std::uint64_t sent() const { return m_sent; }
+    inline std::uint64_t lost() const { return m_lost; }
+    inline std::uint64_t received() const { return m_received; }
+    inline const std::string& getError() const { return m_error; }
+
+private:
+    struct Pending
+    {
+        double                    due;
+        std::vector<std::uint8_t> data;
+    };
+
+    sf::UdpSocket        m_socket;
+    Config               m_config;
+    std::uint64_t        m_rng;
+    std::vector<Pending> m_pending;
+    std::uint64_t        m_sent, m_lost, m_received;
+    std::string          m_error;
+
+    double random01();
+};
+
+#endif // NETLINK_H
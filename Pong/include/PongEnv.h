@@ -0,0 +1,128 @@
+#ifndef PONGENV_H
+#define PONGENV_H
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+//////////////////////////////////////////////////////////
+/////// HEADLESS PONG ENVIRONMENT
+// N independent matches stepped together at a fixed timestep, with no
+// window, texture or sound. Each field of every match lives in its own
+// array (ball x, ball y, ...), so a step walks contiguous memory.
+// Rules follow the game : same sizes and speeds, ball sped up every 3 s,
+// bounce angle from the impact point, 2 s pause after a point.
+// Paddles are kept inside the field, which the game doesn't do.
+//
+// Two agents per match (0 : left paddle, 1 : right paddle). Every agent
+// sees the match from its own side : x is mirrored for the right paddle,
+// so a controller can play either side.
+namespace PongRules{
+    const float FIELD_W      = 1024.f;
+    const float FIELD_H      = 576.f;
+    const float PADDLE_W     = 16.f;
+    const float PADDLE_H     = 128.f;
+    const float PADDLE_X     = 10.f;      // gap between a paddle and its side
+    const float PADDLE_SPEED = 250.f;
+    const float BALL_RADIUS  = 16.f;
+    const float BALL_SPEED   = 300.f;
+    const float SPEED_UP     = 30.f;
+    const float SPEED_UP_T   = 3.f;       // seconds between two speed ups
+    const float OUT_T        = 2.f;       // pause after a point
+    const float MAX_ANGLE    = 45.f;      // bounce angle at the paddle end
+
+    // Moves the ball by 'dt', swept against walls and paddle faces (paddle
+    // tops given). Returns the paddle hits. Shared by every headless core.
+    unsigned moveBall(float& x, float& y, float& dirX, float& dirY, float speed, float dt,
+                      float paddle1, float paddle2);
+    // Random direction away from the vertical, as the game serves
+    void serveDirection(std::uint64_t& rng, float& dirX, float& dirY);
+}
+
+class PongEnv
+{
+public:
+    // Observation of one agent, values roughly in [-1, 1]
+    enum obs{OBS_BALL_X, OBS_BALL_Y, OBS_BALL_VX, OBS_BALL_VY, OBS_OWN_Y, OBS_OTHER_Y, OBS_SERVING, OBS_SIZE};
+    static const std::size_t AGENTS = 2;
+
+    // Actions : -1 up, 0 stay, 1 down
+    typedef std::function<void(const float *obs, std::int8_t *actions, std::size_t agents)> Policy;
+    typedef std::function<Policy(unsigned worker)>                                         PolicyFactory;
+
+    struct Report
+    {
+        std::size_t   matches;
+        unsigned      threads;
+        unsigned      steps;
+        double        seconds;
+        double        stepsPerSec;     // match steps, all threads
+        std::uint64_t points;
+        std::uint64_t hits;            // paddle bounces
+        std::uint64_t finished;        // matches won
+    };
+
+    PongEnv(std::size_t matches, std::uint64_t seed = 1, float dt = 1.f / 120.f, unsigned pointsToWin = 11);
+
+    PongEnv(const PongEnv&) = delete;
+    PongEnv& operator=(const PongEnv&) = delete;
+
+    inline std::size_t size() const { return m_ballX.size(); }
+    inline float getDt() const { return m_dt; }
+
+    ////////// AGENT BUFFERS (agent a of match m : index m*AGENTS + a)
+    inline const float* observations() const { return m_obs.data(); }
+    inline std::int8_t* actions() { return m_actions.data(); }
+    // Last step : +1 scored, -1 conceded
+    inline const float* rewards() const { return m_rewards.data(); }
+    // Match m was won during the last step (scores are already reset)
+    inline const std::uint8_t* done() const { return m_done.data(); }
+
+    inline unsigned getScore(std::size_t match, std::size_t agent) const
+    {
+        return agent == 0 ? m_score1[match] : m_score2[match];
+    }
+
+    ////////// STEP
+    // Applies actions(), moves every match by dt, writes the observations
+    void step();
+    // Same on [begin, end) only : ranges may be stepped by different threads
+    void step(std::size_t begin, std::size_t end);
+    void observe(std::size_t begin, std::size_t end);
+
+    // 'steps' steps on every match, matches split across threads (0 : all
+    // cores). Each worker owns its slice and its policy : no lock, no barrier.
+    Report run(unsigned steps, const PolicyFactory& factory, unsigned threads = 0);
+    static void printReport(std::ostream& os, const Report& report);
+
+    ////////// POLICIES
+    // Follows the ball, with a dead zone against jitter
+    static Policy trackingPolicy(float deadZone = 0.05f);
+    static Policy randomPolicy(std::uint64_t seed);
+
+private:
+    const float    m_dt;
+    const unsigned m_pointsToWin;
+
+    // Match state, one entry per match
+    std::vector<float>         m_ballX, m_ballY;
+    std::vector<float>         m_dirX, m_dirY;     // unit direction
+    std::vector<float>         m_speed;
+    std::vector<float>         m_paddle1, m_paddle2;   // paddle tops
+    std::vector<float>         m_speedTimer;
+    std::vector<float>         m_outTimer;        // > 0 : point scored, waiting for the serve
+    std::vector<std::uint64_t> m_rng;
+    std::vector<unsigned>      m_score1, m_score2;
+    std::vector<std::uint32_t> m_hits, m_points, m_finished;
+
+    // Agent buffers
+    std::vector<float>         m_obs;
+    std::vector<std::int8_t>   m_actions;
+    std::vector<float>         m_rewards;
+    std::vector<std::uint8_t>  m_done;
+
+    void serve(std::size_t m);
+};
+
+#endif // PONGENV_H
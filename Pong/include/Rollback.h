@@ -0,0 +1,122 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "PongEnv.h"
+#include "NetLink.h"
+
+//////////////////////////////////////////////////////////
+/////// MATCH STATE
+// One match in a plain value : a snapshot is a copy of 64 bytes. Stepped
+// with the headless rules (PongRules), at a fixed timestep, from inputs
+// only : two peers with the same inputs and the same build stay in sync.
+struct MatchState
+{
+    float         ballX, ballY;
+    float         dirX, dirY;
+    float         speed;
+    float         paddle[2];      // paddle tops
+    float         speedTimer;
+    float         outTimer;       // > 0 : point scored, waiting for the serve
+    std::uint64_t rng;
+    std::uint32_t score[2];
+    std::uint32_t frame;
+};
+
+MatchState newMatch(std::uint64_t seed);
+// Inputs : -1 up, 0 stay, 1 down
+void stepMatch(MatchState& state, std::int8_t input1, std::int8_t input2, float dt);
+std::uint64_t checksum(const MatchState& state);
+
+//////////////////////////////////////////////////////////
+/////// ROLLBACK SESSION
+// One side of an online match. Each frame the local input is sent (with
+// every input the peer hasn't acknowledged, so a lost datagram costs
+// nothing) and the match goes on right away : a missing remote input is
+// predicted by repeating the last one received. When the real input
+// differs from the prediction, the state of that frame is restored and
+// the frames since are simulated again. The session stalls rather than
+// going more than maxRollback frames ahead of the last remote input.
+// Both peers must use the same seed, dt and input delay.
+class RollbackSession
+{
+public:
+    struct Config
+    {
+        unsigned      localPlayer{0};     // 0 : left paddle, 1 : right paddle
+        unsigned      inputDelay{2};      // frames before a local input is played (up to 8)
+        unsigned      maxRollback{8};     // up to 16
+        std::uint64_t seed{1};
+        float         dt{1.f / 60.f};
+    };
+
+    struct Stats
+    {
+        std::uint64_t frames{0};
+        std::uint64_t stalls{0};          // frames waited for the peer
+        std::uint64_t mispredictions{0};  // remote inputs that differed from the guess
+        std::uint64_t rollbacks{0};
+        std::uint64_t resimFrames{0};
+        unsigned      maxDepth{0};        // frames resimulated by one rollback
+        double        resimMs{0.0};
+        double        maxResimMs{0.0};    // worst frame
+        std::uint64_t checked{0};         // frames compared with the peer
+        std::uint64_t desyncs{0};
+    };
+
+    static const std::uint32_t NO_FRAME = 0xFFFFFFFFu;
+
+    RollbackSession(const Config& config, NetLink& link);
+
+    RollbackSession(const RollbackSession&) = delete;
+    RollbackSession& operator=(const RollbackSession&) = delete;
+
+    // One frame at time 'now' (seconds). False if stalled waiting for the peer.
+    bool update(std::int8_t localInput, double now);
+
+    inline const MatchState& getState() const { return m_state; }
+    inline std::uint32_t getFrame() const { return m_frame; }
+    // Last frame whose inputs are all confirmed, NO_FRAME before the first one
+    inline std::uint32_t getSyncedFrame() const { return m_syncedFrame; }
+    // Checksum of the state at a confirmed frame, if still remembered
+    bool getSyncedChecksum(std::uint32_t frame, std::uint64_t& hash) const;
+
+    inline const Stats& getStats() const { return m_stats; }
+    void printStats(std::ostream& os) const;
+
+private:
+    // Frames kept in the rings. Delay and rollback are capped so that every
+    // frame a peer can still send or ask for fits : 2*(16+8)+2 < 64.
+    static const std::uint32_t RING = 64;
+
+    Config                            m_config;
+    NetLink&                          m_link;
+    MatchState                        m_state;          // start of m_frame
+    std::uint32_t                     m_frame;
+    std::array<MatchState, RING>      m_snapshots;      // start of each frame
+    std::array<std::int8_t, RING>     m_local;          // local inputs, by frame
+    std::array<std::int8_t, RING>     m_remote;         // confirmed remote inputs
+    std::array<std::int8_t, RING>     m_used;           // remote input the frame was played with
+    std::uint32_t                     m_localCount;     // local inputs known : [0, m_localCount)
+    std::uint32_t                     m_remoteCount;    // remote inputs confirmed : [0, m_remoteCount)
+    std::uint32_t                     m_peerAck;        // local inputs the peer has
+    std::uint32_t                     m_rollbackFrom;   // earliest mispredicted frame, NO_FRAME : none
+    std::uint32_t                     m_syncedFrame;
+    std::uint32_t                     m_checkedFrame;   // last peer checksum compared
+    std::array<std::uint64_t, RING>   m_hash;
+    std::array<std::uint32_t, RING>   m_hashFrame;
+    std::vector<std::uint8_t>         m_datagram;
+    Stats                             m_stats;
+
+    void simulate(std::uint32_t frame);
+    void rollback();
+    void recordSynced();
+    void readDatagram(const std::vector<std::uint8_t>& data);
+    void sendInputs(double now);
+};
+
+#endif // ROLLBACK_H
@@ -1,11 +1,22 @@
 #include <iostream>
+#include <string>
 #include <cmath>
+#include <array>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 #include <SFML/Audio.hpp>
 
-#include "include/Outils.h"
+#include "include/PongEnv.h"
+#include "include/Rollback.h"
+#include "../Utilities/Collision.hpp"
+#include "../Utilities/Random.hpp"
+#include "../Utilities/SpriteBatch.hpp"
+#include "../Utilities/Hud.hpp"
+#include "../Utilities/AudioManager.hpp"
+#include "../Utilities/GameLoop.hpp"
+#include "../Utilities/Arguments.hpp"
+#include "../Utilities/AssetLoader.hpp"
 
 //////////////////////////////////////////////
 /////// RESET KEY STATE
@@ -29,101 +40,41 @@ const float    PLAYER_Y    = (WINDOW_H / 2) - (PADDLE_H / 2);
 const float    BALL_RADIUS = 16;
 const float    BALL_X      = (WINDOW_W / 2) - BALL_RADIUS;
 const float    BALL_Y      = (WINDOW_H / 2) - BALL_RADIUS;
+const std::size_t DOTS     = 9;
 
 //////////////////////////////////////////////
 /////// CLASS LEADERBOARD
+// Scores are integers shown by the HUD : digits only move when a point is scored
 class Leaderboard : public sf::Drawable
 {
 public:
-    explicit Leaderboard(unsigned characterSize = 30) :
-        m_playersScore{std::map<std::string, sf::Text>({{"player1", sf::Text()}, {"player2", sf::Text()}})},
-        m_font(sf::Font()),
-        m_box1(sf::RectangleShape()),
-        m_box2(sf::RectangleShape())
-    {
-        m_font.loadFromFile("assets/fonts/OldLondon.ttf");
-
-        for(auto it = m_playersScore.begin(); it != m_playersScore.end(); ++it) {
-            it->second.setFont(m_font);
-            it->second.setString("0");
-            it->second.setCharacterSize(characterSize);
-            it->second.setFillColor(sf::Color::White);
-        }
-
-        m_playersScore["player1"].setPosition(WINDOW_W/2.f - m_playersScore["player1"].getGlobalBounds().width, 0.f);
-        m_playersScore["player2"].setPosition(WINDOW_W/2.f, 0.f);
-        // Offset relative to middle
-        m_playersScore["player1"].move(-30.f, 0.f);
-        m_playersScore["player2"].move(30.f, 0.f);
-
-        m_box1 = createBox(m_playersScore["player1"].getGlobalBounds().left,
-                           m_playersScore["player1"].getGlobalBounds().top,
-                           m_playersScore["player1"].getGlobalBounds().width,
-                           m_playersScore["player1"].getGlobalBounds().height);
+    enum player{PLAYER1, PLAYER2, PLAYER_MAX};
 
-        m_box2 = createBox(m_playersScore["player2"].getGlobalBounds().left,
-                           m_playersScore["player1"].getGlobalBounds().top,
-                           m_playersScore["player2"].getGlobalBounds().width,
-                           m_playersScore["player2"].getGlobalBounds().height);
-    }
-
-    void addPoint(const std::string& player)
+    // Without a font the scores are counted, not shown
+    explicit Leaderboard(AssetLoader::FontHandle font, unsigned characterSize = 30) :
+        m_font(font ? font : std::make_shared<sf::Font>()),
+        m_hud(),
+        m_score{0, 0}
     {
-        std::string tmp{m_playersScore[player].getString()};
-        int score{std::stoi(tmp)};
-        ++score;
-        m_playersScore[player].setString(std::to_string(score));
-        if(player == "player1")
-            updatePosLeftScore();
-        /// DEBUG
-        updateBox();
-    }
+        m_hud.load(*m_font, characterSize);
 
-private:
-    //      <player     , score   >
-    std::map<std::string, sf::Text> m_playersScore;
-    sf::Font                        m_font;
-    sf::RectangleShape              m_box1; /// DEBUG
-    sf::RectangleShape              m_box2; /// DEBUG
-
-    sf::RectangleShape createBox(float x, float y, float w, float h)
-    {
-        sf::RectangleShape tmp{sf::Vector2f(w, h)};
-        tmp.setPosition(x, y);
-        tmp.setFillColor(sf::Color::Transparent);
-        tmp.setOutlineThickness(1);
-        tmp.setOutlineColor(sf::Color::Red);
-
-        return tmp;
-    }
-
-    void updatePosLeftScore()
-    {
-        float width{m_playersScore["player1"].getGlobalBounds().width};
-        m_playersScore["player1"].setPosition((WINDOW_W/2.f) - width, 0.f);
-        m_playersScore["player1"].move(-30.f, 0.f);
+        // Offset relative to middle : player 1 ends 30 px left of it, player 2 starts 30 px right
+        m_score[PLAYER1] = m_hud.addCounter(sf::Vector2f(WINDOW_W/2.f - 30.f, 0.f), Hud::RIGHT, 3);
+        m_score[PLAYER2] = m_hud.addCounter(sf::Vector2f(WINDOW_W/2.f + 30.f, 0.f), Hud::LEFT, 3);
     }
 
-    void updateBox()
-    {
-        m_box1.setPosition(m_playersScore["player1"].getGlobalBounds().left,
-                           m_playersScore["player1"].getGlobalBounds().top);
-        m_box2.setPosition(m_playersScore["player2"].getGlobalBounds().left,
-                           m_playersScore["player2"].getGlobalBounds().top);
+    void addPoint(player p) { m_hud.add(m_score[p], 1); }
+    void setScore(player p, long score) { m_hud.set(m_score[p], score); }
+    long getScore(player p) const { return m_hud.get(m_score[p]); }
 
-        m_box1.setSize(sf::Vector2f(m_playersScore["player1"].getGlobalBounds().width,
-                                    m_playersScore["player1"].getGlobalBounds().height));
-        m_box2.setSize(sf::Vector2f(m_playersScore["player2"].getGlobalBounds().width,
-                                    m_playersScore["player2"].getGlobalBounds().height));
-    }
+private:
+    AssetLoader::FontHandle               m_font;
+    Hud                                   m_hud;
+    std::array<std::size_t, PLAYER_MAX>   m_score;   // HUD counters
 
     void draw(sf::RenderTarget& target, sf::RenderStates states) const
     {
-        //target.draw(m_box1);
-        //target.draw(m_box2);
-        for(auto it = m_playersScore.begin(); it != m_playersScore.end(); ++it) {
-            target.draw(it->second);
-        }
+        target.draw(m_hud, states);
     }
 };
 
@@ -134,16 +85,14 @@ enum dir{
     DOWN = 1
 };
 
+// Drawn from the atlas by the sprite batch, the shape gives the bounds
 class Paddle : public sf::RectangleShape
 {
 public:
     Paddle(float width, float height) :
-        RectangleShape(sf::Vector2f(width, height)),
-        m_texture(sf::Texture())
+        RectangleShape(sf::Vector2f(width, height))
     {
-        m_texture.loadFromFile("assets/img/paddle.png");
-        m_texture.setSmooth(true);
-        setTexture(&m_texture);
+
     }
 
     float top()    const { return getGlobalBounds().top; }
@@ -156,7 +105,6 @@ public:
     }
 
 private:
-    sf::Texture m_texture;
     float       m_speed = 250.f;
 };
 //////////////////////////////////////////////
@@ -166,22 +114,8 @@ class Ball : public sf::CircleShape
 public:
     explicit Ball(float radius = 0, std::size_t pointCount = 30) :
         CircleShape(radius, pointCount),
-        m_box(sf::RectangleShape(sf::Vector2f(radius*2, radius*2))),
-        m_texture(sf::Texture()),
-        m_texture_cracked(sf::Texture()),
-        m_bufferSoundCrack(sf::SoundBuffer())
+        m_box(sf::RectangleShape(sf::Vector2f(radius*2, radius*2)))
     {
-        // Textures
-        m_texture.loadFromFile("assets/img/ball.png");
-        m_texture.setSmooth(true);
-        setTexture(&m_texture);
-        m_texture_cracked.loadFromFile("assets/img/ball_cracked.png");
-        m_texture_cracked.setSmooth(true);
-        // Sounds
-        m_bufferSoundCrack.loadFromFile("assets/sounds/sound_crack.wav");
-        m_soundCrack.setBuffer(m_bufferSoundCrack);
-        m_bufferSoundBounce.loadFromFile("assets/sounds/sound_bounce.wav");
-        m_soundBounce.setBuffer(m_bufferSoundBounce);
         // Origin point (for perfect rotation in middle of texture)
         setOrigin(radius, radius);
         /// View Collide box (draw not necessary, but box's datas are used in collide sys)
@@ -199,6 +133,7 @@ public:
     float limitLeft() const            { return m_limitLeft; }
     float limitRight() const           { return m_limitRight; }
     bool isOut() const                 { return m_isOut; }
+    bool isCracked() const             { return m_isCracked; }
     sf::FloatRect getFloatRect()       { return m_box.getGlobalBounds(); }
     const sf::RectangleShape& getBox() { return m_box; }
 
@@ -207,24 +142,42 @@ public:
         m_limitRight = right;
     }
 
+    // Sounds are played by the shared audio manager (nothing loaded here)
+    void setSounds(AudioManager *audio, std::size_t bounce, std::size_t crack) {
+        m_audio       = audio;
+        m_soundBounce = bounce;
+        m_soundCrack  = crack;
+    }
+
     void setOut(bool isOut) { m_isOut = isOut; }
-    void playCrackSound()   { m_soundCrack.play(); }
-    void playBounceSound()  { m_soundBounce.play(); }
+    void playCrackSound()   { if(m_audio) m_audio->play(m_soundCrack, 1); }
+    void playBounceSound()  { if(m_audio) m_audio->play(m_soundBounce, 0); }
     void bounceH()          { setRotation(360 - getRotation()); }
     //void bounceV()          { setRotation(90 - (getRotation() - 90)); }
 
+    sf::Vector2f getVelocity() const
+    {
+        float radA = getRotation() * ((2.f * PI) / 360.f);
+        return sf::Vector2f(cos(radA) * m_speed, sin(radA) * m_speed);
+    }
+
+    void setVelocity(const sf::Vector2f& velocity)
+    {
+        setRotation(atan2(velocity.y, velocity.x) * (360.f / (2.f * PI)));
+    }
+
+    // Position is the center (origin set in the middle)
+    void moveTo(const sf::Vector2f& center)
+    {
+        setPosition(center);
+        m_box.setPosition(center.x - getRadius(), center.y - getRadius());
+    }
+
+    // Moves are done by moveBall() (swept against walls and paddles)
     void update(const sf::Time& dt)
     {
-        if(!m_isOut) {
-            float radA = getRotation() * ((2.f * PI) / 360.f);
-            float x    = left() + (cos(radA) * m_speed * dt.asSeconds());
-            float y    = top() + (sin(radA) * m_speed * dt.asSeconds());
-            setPosition(x, y);
-            m_box.setPosition(x - getRadius(), y - getRadius());
-        }
-        else {
+        if(m_isOut)
             playAnimOut(dt);
-        }
     }
 
     void speedUp() {
@@ -242,12 +195,9 @@ public:
 
 private:
     sf::RectangleShape m_box;
-    sf::Texture        m_texture;
-    sf::Texture        m_texture_cracked;
-    sf::SoundBuffer    m_bufferSoundCrack;
-    sf::Sound          m_soundCrack;
-    sf::SoundBuffer    m_bufferSoundBounce;
-    sf::Sound          m_soundBounce;
+    AudioManager      *m_audio        = nullptr;
+    std::size_t        m_soundBounce  = AudioManager::NONE;
+    std::size_t        m_soundCrack   = AudioManager::NONE;
     const float        PI             = 3.141592f;
     float              m_defaultSpeed = 300.f;
     float              m_speed        = 300.f;
@@ -255,6 +205,7 @@ private:
     float              m_limitRight   = 0.f;
     float              m_elapsed      = 0.f;
     bool               m_isOut        = false;
+    bool               m_isCracked    = false;
 
     void reset()
     {
@@ -267,7 +218,7 @@ private:
 
     void startRotation()
     {
-        float angle{static_cast<float>(Outils::rollTheDice(0, 359))};
+        float angle{static_cast<float>(Random::between(0, 359))};
 
         if((angle > 225.f && angle < 315.f) ||
            (angle > 45.f && angle < 135.f))
@@ -282,10 +233,10 @@ private:
     {
         m_elapsed += dt.asSeconds();
         if(m_elapsed < 2.f) {
-            setTexture(&m_texture_cracked);
+            m_isCracked = true;
         }
         else {
-            setTexture(&m_texture);
+            m_isCracked = false;
             reset();
             m_elapsed = 0.f;
         }
@@ -347,56 +298,368 @@ bool collideWindow(Ball& b, sf::RenderTarget *window)
     return false;
 }
 //////////////////////////////////////////////
-/////// COLLIDE PADDLE
-void collidePaddle(Ball& b, const Paddle& p1, const Paddle& p2)
+/////// BOUNCE PADDLE (front face : angle from the impact point)
+void bouncePaddle(Ball& b, const Paddle& p, bool player1)
 {
-    const sf::FloatRect player1(p1.getGlobalBounds());
-    const sf::FloatRect player2(p2.getGlobalBounds());
-    const float halfBarre{p1.getGlobalBounds().height / 2.f};
+    const float halfBarre{p.getGlobalBounds().height / 2.f};
     const float ballCenter{b.getPosition().y};
-    const float p1Center{p1.top() + halfBarre};
-    const float p2Center{p2.top() + halfBarre};
-
-    // If Ball is inside player 1
-    if(player1.intersects(b.getFloatRect())) {
+    const float pCenter{p.top() + halfBarre};
 
-        b.playBounceSound();
-
-        if(ballCenter < p1Center) {
-            b.setRotation(360.f - getAngleReflexion(b, p1));
+    if(player1) {
+        if(ballCenter < pCenter) {
+            b.setRotation(360.f - getAngleReflexion(b, p));
         }
-        else if(ballCenter > p1Center) {
-            b.setRotation(getAngleReflexion(b, p1));
+        else if(ballCenter > pCenter) {
+            b.setRotation(getAngleReflexion(b, p));
         }
         else {
             b.setRotation(0.f);
         }
     }
+    else {
+        if(ballCenter < pCenter) {
+            b.setRotation(180.f + getAngleReflexion(b, p));
+        }
+        else if(ballCenter > pCenter) {
+            b.setRotation(180.f - getAngleReflexion(b, p));
+        }
+        else {
+            b.setRotation(180.f);
+        }
+    }
+}
+//////////////////////////////////////////////
+/////// MOVE BALL
+// Swept against top/bottom walls and both paddles : the ball stops at its
+// earliest impact, bounces and goes on with the rest of the frame, so
+// speedUp() or a long frame can't make it pass through a paddle.
+void moveBall(Ball& b, const Paddle& p1, const Paddle& p2, const sf::Time& dt)
+{
+    enum obstacle{WALL_TOP, WALL_BOTTOM, PLAYER1, PLAYER2, OBSTACLE_MAX};
+    const std::array<sf::FloatRect, OBSTACLE_MAX> boxes{{
+        sf::FloatRect(-1.f * WINDOW_W, -1.f * WINDOW_H, 3.f * WINDOW_W, WINDOW_H),
+        sf::FloatRect(-1.f * WINDOW_W, WINDOW_H, 3.f * WINDOW_W, WINDOW_H),
+        p1.getGlobalBounds(),
+        p2.getGlobalBounds()
+    }};
+
+    sf::Vector2f center{b.getPosition()};
+    sf::Vector2f velocity{b.getVelocity()};
+
+    Collision::moveCircle(center, velocity, dt.asSeconds(),
+        [&](const sf::Vector2f& from, const sf::Vector2f& delta){
+            Collision::Contact first;
+            for(std::size_t i = 0; i < boxes.size(); ++i) {
+                const Collision::Hit hit{Collision::sweepCircleRect(from, b.getRadius(), delta, boxes[i])};
+                if(hit.hit && hit.time < first.hit.time) {
+                    first.hit = hit;
+                    first.id  = i;
+                }
+            }
+            return first;
+        },
+        [&](const Collision::Contact& contact, sf::Vector2f& vel){
+            const sf::Vector2f& n{contact.hit.normal};
+            if(contact.id == PLAYER1 || contact.id == PLAYER2) {
+                b.playBounceSound();
+                if((contact.id == PLAYER1 && n.x > 0.f) || (contact.id == PLAYER2 && n.x < 0.f)) {
+                    b.moveTo(center);
+                    bouncePaddle(b, contact.id == PLAYER1 ? p1 : p2, contact.id == PLAYER1);
+                    vel = b.getVelocity();
+                    return;
+                }
+            }
+            vel = Collision::reflect(vel, n);
+        });
 
-    // If Ball is inside player 2
-    if(player2.intersects(b.getFloatRect())) {
+    b.moveTo(center);
+    b.setVelocity(velocity);
+}
+
+//////////////////////////////////////////////
+/////// HEADLESS SIMULATION
+// Pong --sim [matches] [steps] [threads] [seed] [tracking|random]
+int runSimMode(int argc, char *argv[])
+{
+    std::size_t   matches{4096};
+    unsigned      steps{7200};    // one minute of play at 120 Hz
+    unsigned      threads{0};
+    std::uint64_t seed{1};
+    if((argc > 2 && !Arguments::parse(argv[2], matches)) ||
+       (argc > 3 && !Arguments::parse(argv[3], steps)) ||
+       (argc > 4 && !Arguments::parse(argv[4], threads)) ||
+       (argc > 5 && !Arguments::parse(argv[5], seed)) ||
+       (argc > 6 && std::string(argv[6]) != "tracking" && std::string(argv[6]) != "random") ||
+       argc > 7 || matches == 0) {
+        std::cout << "Usage : " << argv[0] << " --sim [matches (1+)] [steps] [threads (0 : all cores)] [seed] [tracking|random]\n";
+        return 1;
+    }
+    const bool useRandom{argc > 6 && std::string(argv[6]) == "random"};
 
-        b.playBounceSound();
+    PongEnv env(matches, seed);
+    const PongEnv::Report report{env.run(steps, [seed, useRandom](unsigned worker){
+        return useRandom ? PongEnv::randomPolicy(seed + worker) : PongEnv::trackingPolicy();
+    }, threads)};
+    PongEnv::printReport(std::cout, report);
 
-        if(ballCenter < p2Center) {
-            b.setRotation(180.f + getAngleReflexion(b, p2));
-        }
-        else if(ballCenter > p2Center) {
-            b.setRotation(180.f - getAngleReflexion(b, p2));
+    return 0;
+}
+
+//////////////////////////////////////////////
+/////// ASSETS (the archive decodes while the window opens, loose files without it)
+void openAssets(AssetLoader& assets)
+{
+    if(!assets.open("assets.pak"))
+        std::cout << "No asset archive (" << assets.getError() << "), loose files\n";
+    assets.start();
+}
+
+// Font of the scores
+AssetLoader::FontHandle scoreFont(AssetLoader& assets)
+{
+    AssetLoader::FontHandle font{assets.getFont("assets/fonts/OldLondon.ttf")};
+    if(!font)
+        std::cout << "Assets : " << assets.getError() << '\n';
+    return font;
+}
+
+/////// ATLAS (paddle, ball, cracked ball and a white patch for the dot line)
+void buildAtlas(TextureAtlas& atlas, AssetLoader& assets)
+{
+    for(const char *name : {"paddle", "ball", "ball_cracked"}){
+        if(auto image = assets.getImage(std::string("assets/img/") + name + ".png"))
+            atlas.add(name, *image);
+        else
+            std::cout << "Assets : " << assets.getError() << '\n';
+    }
+    sf::Image white;
+    white.create(4, 4, sf::Color::White);
+    atlas.add("white", white);
+    if(!atlas.build(2048, true))
+        std::cout << "Atlas : " << atlas.getError() << '\n';
+}
+
+// Dots of the middle line in the first DOTS slots
+void setDotSprites(SpriteBatch& sprites, const TextureAtlas& atlas)
+{
+    // Inner texels only : smoothing would blend the border with the padding
+    const sf::IntRect whiteRect{atlas.get("white").left + 1, atlas.get("white").top + 1, 2, 2};
+    for(std::size_t i = 0; i < DOTS; ++i) {
+        sprites.set(i, sf::FloatRect((WINDOW_W / 2.f) - 2.f, (i*(WINDOW_H / 9.f)) + WINDOW_H / 36.f, 10.f, WINDOW_H / 18.f),
+                    whiteRect);
+    }
+}
+
+//////////////////////////////////////////////
+/////// NETPLAY BOT (follows the ball, sometimes changes its mind)
+std::int8_t botInput(const MatchState& state, unsigned player, std::uint64_t& rng)
+{
+    rng = (rng * 6364136223846793005ull) + 1442695040888963407ull;
+    if(((rng >> 33) % 100) < 15)
+        return static_cast<std::int8_t>(static_cast<int>((rng >> 40) % 3) - 1);
+
+    const float gap{state.ballY - (state.paddle[player] + (PADDLE_H / 2.f))};
+    return static_cast<std::int8_t>((gap > 8.f) - (gap < -8.f));
+}
+
+//////////////////////////////////////////////
+/////// NETPLAY LOOPBACK TEST
+// Pong --net-test [frames] [latencyMs] [loss%] [rollback] [delay]
+// Both players in this process, bots on each side, over UDP on 127.0.0.1.
+// Time is simulated (one frame per loop), so the test runs flat out.
+int runNetTest(int argc, char *argv[])
+{
+    unsigned frames{3600};
+    NetLink::Config linkA, linkB;
+    RollbackSession::Config configA, configB;
+    if((argc > 2 && !Arguments::parse(argv[2], frames)) ||
+       (argc > 3 && !Arguments::parse(argv[3], linkA.latencyMs)) ||
+       (argc > 4 && !Arguments::parse(argv[4], linkA.lossPercent)) ||
+       (argc > 5 && !Arguments::parse(argv[5], configA.maxRollback)) ||
+       (argc > 6 && !Arguments::parse(argv[6], configA.inputDelay)) ||
+       argc > 7) {
+        std::cout << "Usage : " << argv[0] << " --net-test [frames] [latencyMs] [loss%] [rollback] [delay]\n";
+        return 1;
+    }
+    linkA.jitterMs  = linkA.latencyMs / 2.f;
+    linkA.localPort = 47001;
+    linkA.peerPort  = 47002;
+    linkB           = linkA;
+    linkB.localPort = 47002;
+    linkB.peerPort  = 47001;
+    linkB.seed      = 2;
+    configB             = configA;
+    configB.localPlayer = 1;
+
+    NetLink netA, netB;
+    if(!netA.open(linkA) || !netB.open(linkB)) {
+        std::cout << "Net : " << netA.getError() << netB.getError() << '\n';
+        return 1;
+    }
+    RollbackSession player1(configA, netA), player2(configB, netB);
+
+    std::uint64_t rng1{1}, rng2{2};
+    double now{0.0};
+    sf::Clock chrono;
+    for(unsigned loop = 0; loop < frames * 4 && (player1.getFrame() < frames || player2.getFrame() < frames); ++loop) {
+        player1.update(botInput(player1.getState(), 0, rng1), now);
+        player2.update(botInput(player2.getState(), 1, rng2), now);
+        now += configA.dt;
+    }
+    const float seconds{chrono.getElapsedTime().asSeconds()};
+
+    // Last frame both sides hold as final
+    const std::uint32_t frame{std::min(player1.getSyncedFrame(), player2.getSyncedFrame())};
+    std::uint64_t hash1{0}, hash2{0};
+    const bool ok{player1.getSyncedChecksum(frame, hash1) && player2.getSyncedChecksum(frame, hash2) && hash1 == hash2};
+
+    std::cout << frames << " frame(s), latency " << linkA.latencyMs << " ms (+" << linkA.jitterMs << " jitter), loss "
+              << linkA.lossPercent << " %, played in " << (seconds * 1000.f) << " ms\n";
+    player1.printStats(std::cout);
+    player2.printStats(std::cout);
+    std::cout << "Score " << player1.getState().score[0] << " - " << player1.getState().score[1] << '\n'
+              << (ok ? "Final state checksum OK" : "Final state checksum MISMATCH") << " at frame " << frame << '\n';
+
+    return ok ? 0 : 2;
+}
+
+//////////////////////////////////////////////
+/////// NETPLAY
+// Pong --net <localPort> <peerIp> <peerPort> <1|2> [latencyMs] [loss%] [rollback] [delay]
+// Each side plays with Z/S or Up/Down. Latency and loss are added on top
+// of the real network (to try it on one machine).
+int runNetMode(int argc, char *argv[])
+{
+    NetLink::Config linkConfig;
+    RollbackSession::Config config;
+    if(argc < 6 || argc > 10 ||
+       !Arguments::parse(argv[2], linkConfig.localPort) ||
+       !Arguments::parse(argv[4], linkConfig.peerPort) ||
+       (std::string(argv[5]) != "1" && std::string(argv[5]) != "2") ||
+       (argc > 6 && !Arguments::parse(argv[6], linkConfig.latencyMs)) ||
+       (argc > 7 && !Arguments::parse(argv[7], linkConfig.lossPercent)) ||
+       (argc > 8 && !Arguments::parse(argv[8], config.maxRollback)) ||
+       (argc > 9 && !Arguments::parse(argv[9], config.inputDelay))) {
+        std::cout << "Usage : " << argv[0] << " --net <localPort> <peerIp> <peerPort> <1|2> [latencyMs] [loss%] [rollback] [delay]\n";
+        return 1;
+    }
+    linkConfig.peer        = sf::IpAddress(argv[3]);
+    linkConfig.seed        = linkConfig.localPort;
+    config.localPlayer     = (std::string(argv[5]) == "2") ? 1 : 0;
+
+    NetLink link;
+    if(!link.open(linkConfig)) {
+        std::cout << "Net : " << link.getError() << '\n';
+        return 1;
+    }
+    RollbackSession session(config, link);
+
+    sf::Clock startup;
+    AssetLoader assets;
+    openAssets(assets);
+
+    sf::RenderWindow window(sf::VideoMode(WINDOW_W, WINDOW_H), "Pong (online)", sf::Style::Close);
+
+    TextureAtlas atlas;
+    buildAtlas(atlas, assets);
+    const sf::IntRect paddleRect{atlas.get("paddle")};
+    const sf::IntRect ballRect{atlas.get("ball")};
+    const sf::IntRect crackedRect{atlas.get("ball_cracked")};
+
+    Leaderboard leaderboard(scoreFont(assets), 75);
+    SpriteBatch sprites{&atlas.getTexture(), DOTS + 3};
+    setDotSprites(sprites, atlas);
+
+    assets.printStats(std::cout);
+    std::cout << "Startup : " << startup.getElapsedTime().asMilliseconds() << " ms\n";
+
+    /////// LOOP (the session plays whole frames only)
+    GameLoop loop(config.dt, 60);
+    sf::Clock netClock;
+    while (window.isOpen())
+    {
+        loop.beginFrame();
+
+        sf::Event event;
+        while (window.pollEvent(event))
+        {
+            if (event.type == sf::Event::Closed ||
+                (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape))
+                window.close();
         }
-        else {
-            b.setRotation(0.f);
+
+        const bool up{window.hasFocus() &&
+                      (sf::Keyboard::isKeyPressed(sf::Keyboard::Z) || sf::Keyboard::isKeyPressed(sf::Keyboard::Up))};
+        const bool down{window.hasFocus() &&
+                        (sf::Keyboard::isKeyPressed(sf::Keyboard::S) || sf::Keyboard::isKeyPressed(sf::Keyboard::Down))};
+        const std::int8_t input{static_cast<std::int8_t>(down - up)};
+
+        while(loop.step())
+            session.update(input, netClock.getElapsedTime().asSeconds());
+
+        // Draw the present state (predicted until the peer's inputs come)
+        const MatchState& state = session.getState();
+        sprites.set(DOTS, sf::FloatRect(PLAYER1_X, state.paddle[0], PADDLE_W, PADDLE_H), paddleRect);
+        sprites.set(DOTS + 1, sf::FloatRect(PLAYER2_X, state.paddle[1], PADDLE_W, PADDLE_H), paddleRect);
+        sprites.set(DOTS + 2, sf::FloatRect(state.ballX - BALL_RADIUS, state.ballY - BALL_RADIUS, BALL_RADIUS*2.f, BALL_RADIUS*2.f),
+                    state.outTimer > 0.f ? crackedRect : ballRect);
+        leaderboard.setScore(Leaderboard::PLAYER1, state.score[0]);
+        leaderboard.setScore(Leaderboard::PLAYER2, state.score[1]);
+
+        const RollbackSession::Stats& stats = session.getStats();
+        if(stats.frames > 0 && stats.frames % 60 == 0) {
+            window.setTitle("Pong (online) - rollback max " + std::to_string(stats.maxDepth) +
+                            ", resim " + std::to_string(static_cast<unsigned>((stats.resimMs * 1000.0) / stats.frames)) +
+                            " us/frame, stalls " + std::to_string(stats.stalls));
         }
+
+        window.clear();
+        window.draw(sprites);
+        window.draw(leaderboard);
+        window.display();
+
+        loop.endFrame(window.hasFocus());
     }
+
+    session.printStats(std::cout);
+    return 0;
 }
 
 //////////////////////////////////////////////
-int main()
+int main(int argc, char *argv[])
 {
+    if(argc > 1 && std::string(argv[1]) == "--sim")
+        return runSimMode(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "--net-test")
+        return runNetTest(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "--net")
+        return runNetMode(argc, argv);
+
+    // ASSETS
+    sf::Clock startup;
+    AssetLoader assets;
+    openAssets(assets);
+
     sf::RenderWindow window(sf::VideoMode(WINDOW_W, WINDOW_H), "Pong", sf::Style::Close);
 
+    // ATLAS
+    TextureAtlas atlas;
+    buildAtlas(atlas, assets);
+    const sf::IntRect paddleRect{atlas.get("paddle")};
+    const sf::IntRect ballRect{atlas.get("ball")};
+    const sf::IntRect crackedRect{atlas.get("ball_cracked")};
+
+    // AUDIO (decoded once, played on a pool of voices by the audio thread)
+    AudioManager audio(8);
+    const std::size_t soundBounce{audio.add(assets.getSound("assets/sounds/sound_bounce.wav"))};
+    const std::size_t soundCrack{audio.add(assets.getSound("assets/sounds/sound_crack.wav"))};
+    if(soundBounce == AudioManager::NONE || soundCrack == AudioManager::NONE)
+        std::cout << "Audio : " << assets.getError() << '\n';
+    audio.start();
+
     // BALL
     Ball myBall(BALL_RADIUS, 32);
+    myBall.setSounds(&audio, soundBounce, soundCrack);
     myBall.setPosition(BALL_X, BALL_Y);
     myBall.setLimit(PLAYER1_X + PADDLE_W, PLAYER2_X);
 
@@ -409,24 +672,29 @@ int main()
     player2.setPosition(PLAYER2_X, PLAYER_Y);
 
     // LEADERBOARD
-    Leaderboard leaderboard(75);
+    Leaderboard leaderboard(scoreFont(assets), 75);
 
-    // DOT LINE
-    std::vector<sf::RectangleShape> middleDotLine(9, sf::RectangleShape{sf::Vector2f(10.f, WINDOW_H / 18.f)});
-    for(std::size_t i = 0; i < middleDotLine.size(); ++i) {
-        middleDotLine[i].setPosition((WINDOW_W / 2.f) - 2.f, (i*(WINDOW_H / 9.f)) + WINDOW_H / 36.f);
-    }
+    // SPRITES (dot line, paddles, ball : one batch, one draw call)
+    // Slots : dots, player 1, player 2, ball
+    SpriteBatch sprites{&atlas.getTexture(), DOTS + 3};
+    setDotSprites(sprites, atlas);
+
+    assets.printStats(std::cout);
+    std::cout << "Startup : " << startup.getElapsedTime().asMilliseconds() << " ms\n";
 
-    /////// CLOCK/DT
-    sf::Clock clock;
-    sf::Time dt;
+    /////// LOOP (120 fixed steps/s, 120 fps at most)
+    GameLoop loop(1.f / 120.f, 120);
+    const sf::Time dt{sf::seconds(loop.getStep())};
     float timer{0.f};
 
+    // Positions before the last step : frames are drawn in between
+    sf::Vector2f ballFrom{myBall.getPosition()};
+    sf::Vector2f player1From{player1.getPosition()}, player2From{player2.getPosition()};
+
     /////// GAME LOOP
     while (window.isOpen())
     {
-        dt = clock.restart();
-        timer += dt.asSeconds();
+        loop.beginFrame();
 
         /////// EVENTS
         sf::Event event;
@@ -444,6 +712,7 @@ int main()
                 /// DEBUG
                 if (event.key.code == sf::Keyboard::D) {
                     std::cout << myBall << '\n';
+                    loop.printStats(std::cout);
                 }
 
                 if(event.key.code == sf::Keyboard::Escape)
@@ -486,47 +755,67 @@ int main()
                 window.close();
         }
 
-        /////// UPDATE
-        if(!myBall.isOut()) {
-            // Collide Window
-            if(collideWindow(myBall, &window)) {
-                if(myBall.left() <= myBall.getRadius())
-                    leaderboard.addPoint("player2");
-                else if(myBall.right() >= WINDOW_W)
-                    leaderboard.addPoint("player1");
+        /////// UPDATE (fixed steps)
+        while(loop.step()) {
+            ballFrom    = myBall.getPosition();
+            player1From = player1.getPosition();
+            player2From = player2.getPosition();
+            timer      += dt.asSeconds();
+
+            if(!myBall.isOut()) {
+                // Move (walls and paddles)
+                moveBall(myBall, player1, player2, dt);
+
+                // Collide Window
+                if(collideWindow(myBall, &window)) {
+                    if(myBall.left() <= myBall.getRadius())
+                        leaderboard.addPoint(Leaderboard::PLAYER2);
+                    else if(myBall.right() >= WINDOW_W)
+                        leaderboard.addPoint(Leaderboard::PLAYER1);
+                }
+                // Speed Ball
+                if(timer > 3.f) {
+                    myBall.speedUp();
+                    timer = 0.f;
+                }
             }
-            // Collide Paddle
-            collidePaddle(myBall, player1, player2);
-
-            // Speed Ball
-            if(timer > 3.f) {
-                myBall.speedUp();
+            else {
                 timer = 0.f;
             }
-        }
-        else {
-            timer = 0.f;
-        }
 
-        // Players
-        if(key[P1_UP])   { player1.update(dt, dir::UP); }
-        if(key[P2_UP])   { player2.update(dt, dir::UP); }
-        if(key[P1_DOWN]) { player1.update(dt, dir::DOWN); }
-        if(key[P2_DOWN]) { player2.update(dt, dir::DOWN); }
+            // Players
+            if(key[P1_UP])   { player1.update(dt, dir::UP); }
+            if(key[P2_UP])   { player2.update(dt, dir::UP); }
+            if(key[P1_DOWN]) { player1.update(dt, dir::DOWN); }
+            if(key[P2_DOWN]) { player2.update(dt, dir::DOWN); }
 
-        // Ball
-        myBall.update(dt);
+            // Ball (out animation)
+            myBall.update(dt);
+
+            // Served again : no sliding in from the side
+            if(std::abs(myBall.getPosition().x - ballFrom.x) > WINDOW_W / 4.f)
+                ballFrom = myBall.getPosition();
+        }
+
+        // Sprites, 'alpha' of the way from the previous step (unchanged quads aren't rewritten)
+        const float alpha{loop.getAlpha()};
+        auto between = [alpha](const sf::Vector2f& from, const sf::Vector2f& to) {
+            return sf::Transform().translate((from - to) * (1.f - alpha));
+        };
+        sprites.set(DOTS, between(player1From, player1.getPosition()) * player1.getTransform(), player1.getSize(), paddleRect);
+        sprites.set(DOTS + 1, between(player2From, player2.getPosition()) * player2.getTransform(), player2.getSize(), paddleRect);
+        sprites.set(DOTS + 2, between(ballFrom, myBall.getPosition()) * myBall.getTransform(),
+                    sf::Vector2f(myBall.getRadius()*2.f, myBall.getRadius()*2.f),
+                    myBall.isCracked() ? crackedRect : ballRect);
 
         /////// DRAW
         window.clear();
-        for(const auto& x: middleDotLine)
-            window.draw(x);
-        window.draw(player1);
-        window.draw(player2);
-        window.draw(myBall);
+        window.draw(sprites);
         //window.draw(myBall.getBox()); /// DEBUG
         window.draw(leaderboard);
         window.display();
+
+        loop.endFrame(window.hasFocus());
     }
 
     return 0;
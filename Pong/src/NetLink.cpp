@@ -0,0 +1,86 @@
+#include "../include/NetLink.h"
+#include "../../Utilities/Random.hpp"
+
+#include <utility>
+
+NetLink::NetLink() :
+    m_socket(),
+    m_config(),
+    m_rng{0},
+    m_pending(),
+    m_sent{0}, m_lost{0}, m_received{0},
+    m_error()
+{
+
+}
+
+bool NetLink::open(const Config& config)
+{
+    m_config = config;
+    m_rng    = config.seed;
+
+    if(m_socket.bind(config.localPort) != sf::Socket::Done){
+        m_error = "can't bind UDP port " + std::to_string(config.localPort);
+        return false;
+    }
+    m_socket.setBlocking(false);
+    return true;
+}
+
+////////// SEND
+void NetLink::send(const std::vector<std::uint8_t>& datagram, double now)
+{
+    ++m_sent;
+    if(m_config.lossPercent > 0.f && random01() * 100.0 < m_config.lossPercent){
+        ++m_lost;
+        return;
+    }
+
+    const double delay{(m_config.latencyMs + (m_config.jitterMs * random01())) / 1000.0};
+    if(delay <= 0.0){
+        m_socket.send(datagram.data(), datagram.size(), m_config.peer, m_config.peerPort);
+        return;
+    }
+    m_pending.push_back(Pending{now + delay, datagram});
+}
+
+// Jitter may reorder datagrams, as a real network does
+void NetLink::flush(double now)
+{
+    std::size_t kept{0};
+    for(std::size_t i=0; i<m_pending.size(); ++i){
+        if(m_pending[i].due <= now){
+            m_socket.send(m_pending[i].data.data(), m_pending[i].data.size(), m_config.peer, m_config.peerPort);
+            continue;
+        }
+        if(kept != i)
+            m_pending[kept] = std::move(m_pending[i]);
+        ++kept;
+    }
+    m_pending.resize(kept);
+}
+
+////////// RECEIVE
+bool NetLink::receive(std::vector<std::uint8_t>& datagram)
+{
+    datagram.resize(sf::UdpSocket::MaxDatagramSize);
+    std::size_t size{0};
+    sf::IpAddress sender;
+    unsigned short port{0};
+
+    while(m_socket.receive(datagram.data(), datagram.size(), size, sender, port) == sf::Socket::Done){
+        // Only the peer is listened to
+        if(sender != m_config.peer || port != m_config.peerPort)
+            continue;
+        datagram.resize(size);
+        ++m_received;
+        return true;
+    }
+    return false;
+}
+
+double NetLink::random01()
+{
+    m_rng = Random::mix(m_rng);
+    return (m_rng >> 11) * (1.0 / 9007199254740992.0);
+}
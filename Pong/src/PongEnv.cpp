@@ -0,0 +1,320 @@
+#include "../include/PongEnv.h"
+#include "../../Utilities/Random.hpp"
+
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+using namespace PongRules;
+
+namespace {
+
+const float PI_F{3.141592f};
+
+// Paddle front faces, where the ball center bounces
+const float FACE_LEFT{PADDLE_X + PADDLE_W + BALL_RADIUS};
+const float FACE_RIGHT{FIELD_W - PADDLE_X - PADDLE_W - BALL_RADIUS};
+
+inline float clampf(float v, float lo, float hi)
+{
+    return std::min(std::max(v, lo), hi);
+}
+
+inline float sign(std::int8_t action)
+{
+    return static_cast<float>((action > 0) - (action < 0));
+}
+
+// Time of [0, 1] when 'from' + t*delta reaches 'to', 2 if it doesn't
+inline float crossing(float from, float delta, float to)
+{
+    if(delta == 0.f)
+        return 2.f;
+    const float t{(to - from) / delta};
+    return (t >= 0.f && t <= 1.f) ? t : 2.f;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+/////// RULES
+// The ball stops at its earliest contact, bounces and goes on with the
+// rest of the move
+unsigned PongRules::moveBall(float& x, float& y, float& dirX, float& dirY, float speed, float dt,
+                             float paddle1, float paddle2)
+{
+    unsigned hits{0};
+    float left{speed * dt};
+
+    for(int contact=0; contact<4 && left > 0.f; ++contact){
+        const float mx{dirX * left}, my{dirY * left};
+
+        enum obstacle{NONE, WALL, PADDLE1, PADDLE2};
+        obstacle first{NONE};
+        float t{1.f};
+
+        const float wall{crossing(y, my, my < 0.f ? BALL_RADIUS : FIELD_H - BALL_RADIUS)};
+        if(wall < t){
+            t     = wall;
+            first = WALL;
+        }
+        if(mx < 0.f && x >= FACE_LEFT){
+            const float face{crossing(x, mx, FACE_LEFT)};
+            const float hy{y + (my * face)};
+            if(face < t && hy >= paddle1 - BALL_RADIUS && hy <= paddle1 + PADDLE_H + BALL_RADIUS){
+                t     = face;
+                first = PADDLE1;
+            }
+        }
+        if(mx > 0.f && x <= FACE_RIGHT){
+            const float face{crossing(x, mx, FACE_RIGHT)};
+            const float hy{y + (my * face)};
+            if(face < t && hy >= paddle2 - BALL_RADIUS && hy <= paddle2 + PADDLE_H + BALL_RADIUS){
+                t     = face;
+                first = PADDLE2;
+            }
+        }
+
+        x    += mx * t;
+        y    += my * t;
+        left -= left * t;
+
+        if(first == WALL){
+            dirY = -dirY;
+        }
+        else if(first == PADDLE1 || first == PADDLE2){
+            // Same as the game : angle grows with the distance to the paddle center
+            const float top{first == PADDLE1 ? paddle1 : paddle2};
+            const float angle{(y - (top + (PADDLE_H / 2.f))) * (MAX_ANGLE / (PADDLE_H / 2.f)) * (PI_F / 180.f)};
+            dirX = (first == PADDLE1 ? 1.f : -1.f) * std::cos(angle);
+            dirY = std::sin(angle);
+            ++hits;
+        }
+        else{
+            break;
+        }
+    }
+
+    return hits;
+}
+
+void PongRules::serveDirection(std::uint64_t& rng, float& dirX, float& dirY)
+{
+    rng = Random::mix(rng);
+    float angle{static_cast<float>(rng % 360)};
+    if((angle > 225.f && angle < 315.f) || (angle > 45.f && angle < 135.f))
+        angle -= 90.f;
+
+    const float rad{angle * (PI_F / 180.f)};
+    dirX = std::cos(rad);
+    dirY = std::sin(rad);
+}
+
+PongEnv::PongEnv(std::size_t matches, std::uint64_t seed, float dt, unsigned pointsToWin) :
+    m_dt{dt},
+    m_pointsToWin{std::max(1u, pointsToWin)},
+    m_ballX(matches), m_ballY(matches),
+    m_dirX(matches), m_dirY(matches),
+    m_speed(matches),
+    m_paddle1(matches, (FIELD_H - PADDLE_H) / 2.f), m_paddle2(matches, (FIELD_H - PADDLE_H) / 2.f),
+    m_speedTimer(matches), m_outTimer(matches, 0.f),
+    m_rng(matches),
+    m_score1(matches, 0), m_score2(matches, 0),
+    m_hits(matches, 0), m_points(matches, 0), m_finished(matches, 0),
+    m_obs(matches * AGENTS * OBS_SIZE),
+    m_actions(matches * AGENTS, 0),
+    m_rewards(matches * AGENTS, 0.f),
+    m_done(matches, 0)
+{
+    // Match m only depends on (seed, m)
+    for(std::size_t m=0; m<matches; ++m){
+        m_rng[m] = Random::mix(seed ^ Random::mix(m));
+        serve(m);
+    }
+    observe(0, matches);
+}
+
+////////// STEP
+void PongEnv::step()
+{
+    step(0, size());
+}
+
+void PongEnv::step(std::size_t begin, std::size_t end)
+{
+    std::fill(m_rewards.begin() + (begin * AGENTS), m_rewards.begin() + (end * AGENTS), 0.f);
+    std::fill(m_done.begin() + begin, m_done.begin() + end, 0);
+
+    const float paddleStep{PADDLE_SPEED * m_dt};
+    for(std::size_t m=begin; m<end; ++m){
+        // Paddles move during the pause too
+        m_paddle1[m] = clampf(m_paddle1[m] + (sign(m_actions[m*AGENTS]) * paddleStep), 0.f, FIELD_H - PADDLE_H);
+        m_paddle2[m] = clampf(m_paddle2[m] + (sign(m_actions[(m*AGENTS)+1]) * paddleStep), 0.f, FIELD_H - PADDLE_H);
+
+        if(m_outTimer[m] > 0.f){
+            m_outTimer[m] -= m_dt;
+            if(m_outTimer[m] <= 0.f)
+                serve(m);
+            continue;
+        }
+
+        m_speedTimer[m] += m_dt;
+        if(m_speedTimer[m] > SPEED_UP_T){
+            m_speed[m]     += SPEED_UP;
+            m_speedTimer[m] = 0.f;
+        }
+
+        m_hits[m] += moveBall(m_ballX[m], m_ballY[m], m_dirX[m], m_dirY[m], m_speed[m], m_dt,
+                              m_paddle1[m], m_paddle2[m]);
+
+        // Point : the ball reached a side
+        int scorer{-1};
+        if(m_ballX[m] <= BALL_RADIUS)
+            scorer = 1;
+        else if(m_ballX[m] + BALL_RADIUS >= FIELD_W)
+            scorer = 0;
+        if(scorer < 0)
+            continue;
+
+        m_rewards[(m*AGENTS) + scorer]     =  1.f;
+        m_rewards[(m*AGENTS) + 1 - scorer] = -1.f;
+        m_outTimer[m] = OUT_T;
+        ++m_points[m];
+
+        unsigned& score = (scorer == 0) ? m_score1[m] : m_score2[m];
+        if(++score >= m_pointsToWin){
+            m_done[m]   = 1;
+            m_score1[m] = m_score2[m] = 0;
+            ++m_finished[m];
+        }
+    }
+
+    observe(begin, end);
+}
+
+// Center of the field, random angle away from the vertical (as the game)
+void PongEnv::serve(std::size_t m)
+{
+    serveDirection(m_rng[m], m_dirX[m], m_dirY[m]);
+    m_ballX[m]      = FIELD_W / 2.f;
+    m_ballY[m]      = FIELD_H / 2.f;
+    m_speed[m]      = BALL_SPEED;
+    m_speedTimer[m] = 0.f;
+    m_outTimer[m]   = 0.f;
+}
+
+////////// OBSERVATIONS
+void PongEnv::observe(std::size_t begin, std::size_t end)
+{
+    const float toX{2.f / FIELD_W}, toY{2.f / FIELD_H}, toV{1.f / 1000.f};
+
+    for(std::size_t m=begin; m<end; ++m){
+        const float bx{(m_ballX[m] * toX) - 1.f}, by{(m_ballY[m] * toY) - 1.f};
+        const float vx{m_dirX[m] * m_speed[m] * toV}, vy{m_dirY[m] * m_speed[m] * toV};
+        const float p1{((m_paddle1[m] + (PADDLE_H / 2.f)) * toY) - 1.f};
+        const float p2{((m_paddle2[m] + (PADDLE_H / 2.f)) * toY) - 1.f};
+        const float serving{m_outTimer[m] > 0.f ? 1.f : 0.f};
+
+        float *left = &m_obs[m * AGENTS * OBS_SIZE];
+        left[OBS_BALL_X]  = bx;
+        left[OBS_BALL_Y]  = by;
+        left[OBS_BALL_VX] = vx;
+        left[OBS_BALL_VY] = vy;
+        left[OBS_OWN_Y]   = p1;
+        left[OBS_OTHER_Y] = p2;
+        left[OBS_SERVING] = serving;
+
+        // Right paddle : mirrored, its own side is on the left too
+        float *right = left + OBS_SIZE;
+        right[OBS_BALL_X]  = -bx;
+        right[OBS_BALL_Y]  = by;
+        right[OBS_BALL_VX] = -vx;
+        right[OBS_BALL_VY] = vy;
+        right[OBS_OWN_Y]   = p2;
+        right[OBS_OTHER_Y] = p1;
+        right[OBS_SERVING] = serving;
+    }
+}
+
+////////// RUN
+PongEnv::Report PongEnv::run(unsigned steps, const PolicyFactory& factory, unsigned threads)
+{
+    const std::size_t matches{size()};
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, matches)));
+
+    auto total = [](const std::vector<std::uint32_t>& v){
+        std::uint64_t sum{0};
+        for(auto x : v)
+            sum += x;
+        return sum;
+    };
+    const std::uint64_t points{total(m_points)}, hits{total(m_hits)}, finished{total(m_finished)};
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Contiguous slices : a worker only touches its own matches
+    const std::size_t slice{(matches + threads - 1) / threads};
+    std::vector<std::thread> workers;
+    for(unsigned w=0; w<threads; ++w){
+        const std::size_t begin{std::min(matches, w * slice)}, end{std::min(matches, begin + slice)};
+        workers.emplace_back([this, &factory, steps, w, begin, end](){
+            const Policy policy{factory(w)};
+            for(unsigned s=0; s<steps; ++s){
+                policy(&m_obs[begin * AGENTS * OBS_SIZE], &m_actions[begin * AGENTS], (end - begin) * AGENTS);
+                step(begin, end);
+            }
+        });
+    }
+    for(auto&& t : workers)
+        t.join();
+
+    const double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    Report report{};
+    report.matches     = matches;
+    report.threads     = threads;
+    report.steps       = steps;
+    report.seconds     = seconds;
+    report.stepsPerSec = (seconds > 0) ? (static_cast<double>(matches) * steps) / seconds : 0;
+    report.points      = total(m_points) - points;
+    report.hits        = total(m_hits) - hits;
+    report.finished    = total(m_finished) - finished;
+
+    return report;
+}
+
+void PongEnv::printReport(std::ostream& os, const Report& report)
+{
+    os << std::fixed
+       << report.matches << " match(es) x " << report.steps << " step(s) on " << report.threads << " thread(s) in "
+       << std::setprecision(3) << report.seconds << " s -> " << std::setprecision(0) << report.stepsPerSec << " steps/s\n"
+       << report.points << " point(s), " << report.hits << " paddle hit(s), " << report.finished << " match(es) won\n";
+}
+
+////////// POLICIES
+PongEnv::Policy PongEnv::trackingPolicy(float deadZone)
+{
+    return [deadZone](const float *obs, std::int8_t *actions, std::size_t agents){
+        for(std::size_t a=0; a<agents; ++a){
+            const float *o = &obs[a * OBS_SIZE];
+            const float gap{o[OBS_BALL_Y] - o[OBS_OWN_Y]};
+            actions[a] = static_cast<std::int8_t>((gap > deadZone) - (gap < -deadZone));
+        }
+    };
+}
+
+PongEnv::Policy PongEnv::randomPolicy(std::uint64_t seed)
+{
+    std::uint64_t state{seed};
+
+    return [state](const float*, std::int8_t *actions, std::size_t agents) mutable {
+        for(std::size_t a=0; a<agents; ++a){
+            state = Random::mix(state);
+            actions[a] = static_cast<std::int8_t>(static_cast<int>(state % 3) - 1);
+        }
+    };
+}
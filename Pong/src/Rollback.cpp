@@ -0,0 +1,345 @@
+#include "../include/Rollback.h"
+#include "../../Utilities/Random.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <algorithm>
+
+const std::uint32_t RollbackSession::NO_FRAME;
+const std::uint32_t RollbackSession::RING;
+
+using namespace PongRules;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Datagram : magic, ack, checked frame + checksum, first frame, count, inputs
+const std::uint32_t MAGIC{0x31424B52u};   // "RKB1"
+const std::size_t   HEADER{4 + 4 + 4 + 8 + 4 + 1};
+
+inline float clampf(float v, float lo, float hi)
+{
+    return std::min(std::max(v, lo), hi);
+}
+
+inline float sign(std::int8_t input)
+{
+    return static_cast<float>((input > 0) - (input < 0));
+}
+
+// Little endian, whatever the machine
+void write32(std::vector<std::uint8_t>& out, std::uint32_t v)
+{
+    for(int k=0; k<4; ++k)
+        out.push_back(static_cast<std::uint8_t>(v >> (8*k)));
+}
+
+std::uint32_t read32(const std::uint8_t *in)
+{
+    std::uint32_t v{0};
+    for(int k=0; k<4; ++k)
+        v |= static_cast<std::uint32_t>(in[k]) << (8*k);
+    return v;
+}
+
+// FNV-1a over the bytes of a value
+void hashBytes(std::uint64_t& h, const void *data, std::size_t size)
+{
+    const std::uint8_t *p = static_cast<const std::uint8_t*>(data);
+    for(std::size_t i=0; i<size; ++i){
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+}
+
+template<typename T>
+void hashValue(std::uint64_t& h, const T& value)
+{
+    hashBytes(h, &value, sizeof(value));
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+/////// MATCH STATE
+MatchState newMatch(std::uint64_t seed)
+{
+    MatchState s;
+    std::memset(&s, 0, sizeof(s));
+    s.rng       = Random::mix(seed);
+    s.paddle[0] = s.paddle[1] = (FIELD_H - PADDLE_H) / 2.f;
+    s.ballX     = FIELD_W / 2.f;
+    s.ballY     = FIELD_H / 2.f;
+    s.speed     = BALL_SPEED;
+    serveDirection(s.rng, s.dirX, s.dirY);
+    return s;
+}
+
+// Same rules as PongEnv::step
+void stepMatch(MatchState& s, std::int8_t input1, std::int8_t input2, float dt)
+{
+    ++s.frame;
+    s.paddle[0] = clampf(s.paddle[0] + (sign(input1) * PADDLE_SPEED * dt), 0.f, FIELD_H - PADDLE_H);
+    s.paddle[1] = clampf(s.paddle[1] + (sign(input2) * PADDLE_SPEED * dt), 0.f, FIELD_H - PADDLE_H);
+
+    if(s.outTimer > 0.f){
+        s.outTimer -= dt;
+        if(s.outTimer <= 0.f){
+            serveDirection(s.rng, s.dirX, s.dirY);
+            s.ballX      = FIELD_W / 2.f;
+            s.ballY      = FIELD_H / 2.f;
+            s.speed      = BALL_SPEED;
+            s.speedTimer = 0.f;
+            s.outTimer   = 0.f;
+        }
+        return;
+    }
+
+    s.speedTimer += dt;
+    if(s.speedTimer > SPEED_UP_T){
+        s.speed     += SPEED_UP;
+        s.speedTimer = 0.f;
+    }
+
+    moveBall(s.ballX, s.ballY, s.dirX, s.dirY, s.speed, dt, s.paddle[0], s.paddle[1]);
+
+    if(s.ballX <= BALL_RADIUS){
+        ++s.score[1];
+        s.outTimer = OUT_T;
+    }
+    else if(s.ballX + BALL_RADIUS >= FIELD_W){
+        ++s.score[0];
+        s.outTimer = OUT_T;
+    }
+}
+
+// Field by field : padding bytes never count
+std::uint64_t checksum(const MatchState& s)
+{
+    std::uint64_t h{0xCBF29CE484222325ull};
+    hashValue(h, s.ballX);
+    hashValue(h, s.ballY);
+    hashValue(h, s.dirX);
+    hashValue(h, s.dirY);
+    hashValue(h, s.speed);
+    hashValue(h, s.paddle);
+    hashValue(h, s.speedTimer);
+    hashValue(h, s.outTimer);
+    hashValue(h, s.rng);
+    hashValue(h, s.score);
+    hashValue(h, s.frame);
+    return h;
+}
+
+//////////////////////////////////////////////////////////
+/////// ROLLBACK SESSION
+RollbackSession::RollbackSession(const Config& config, NetLink& link) :
+    m_config(config),
+    m_link(link),
+    m_state(newMatch(config.seed)),
+    m_frame{0},
+    m_snapshots(),
+    m_local(), m_remote(), m_used(),
+    m_localCount{0}, m_remoteCount{0},
+    m_peerAck{0},
+    m_rollbackFrom{NO_FRAME},
+    m_syncedFrame{NO_FRAME},
+    m_checkedFrame{NO_FRAME},
+    m_hash(), m_hashFrame(),
+    m_datagram(),
+    m_stats()
+{
+    m_config.localPlayer = std::min(m_config.localPlayer, 1u);
+    m_config.inputDelay  = std::min(m_config.inputDelay, 8u);
+    m_config.maxRollback = std::max(1u, std::min(m_config.maxRollback, 16u));
+
+    // The first 'delay' frames are played with no input, on both sides
+    m_local.fill(0);
+    m_remote.fill(0);
+    m_used.fill(0);
+    m_hashFrame.fill(NO_FRAME);
+    m_localCount  = m_config.inputDelay;
+    m_remoteCount = m_config.inputDelay;
+    m_peerAck     = m_config.inputDelay;
+}
+
+////////// UPDATE
+bool RollbackSession::update(std::int8_t localInput, double now)
+{
+    // Played 'delay' frames from now, once (a stalled frame doesn't add one)
+    if(m_localCount <= m_frame + m_config.inputDelay){
+        m_local[m_localCount % RING] = localInput;
+        ++m_localCount;
+    }
+
+    while(m_link.receive(m_datagram))
+        readDatagram(m_datagram);
+
+    if(m_rollbackFrom != NO_FRAME)
+        rollback();
+    recordSynced();
+
+    bool advanced{false};
+    if(m_frame < m_remoteCount + m_config.maxRollback){
+        simulate(m_frame);
+        ++m_frame;
+        ++m_stats.frames;
+        advanced = true;
+    }
+    else{
+        ++m_stats.stalls;
+    }
+
+    sendInputs(now);
+    m_link.flush(now);
+    return advanced;
+}
+
+// Plays 'frame' from m_state, remote input confirmed or predicted
+void RollbackSession::simulate(std::uint32_t frame)
+{
+    m_snapshots[frame % RING] = m_state;
+
+    std::int8_t remote{0};
+    if(frame < m_remoteCount)
+        remote = m_remote[frame % RING];
+    else if(m_remoteCount > 0)
+        remote = m_remote[(m_remoteCount - 1) % RING];
+    m_used[frame % RING] = remote;
+
+    const std::int8_t local{m_local[frame % RING]};
+    if(m_config.localPlayer == 0)
+        stepMatch(m_state, local, remote, m_config.dt);
+    else
+        stepMatch(m_state, remote, local, m_config.dt);
+}
+
+// Back to the first wrong guess, then forward to the present again
+void RollbackSession::rollback()
+{
+    const Clock::time_point start{Clock::now()};
+
+    const std::uint32_t from{m_rollbackFrom}, depth{m_frame - from};
+    m_state = m_snapshots[from % RING];
+    for(std::uint32_t f=from; f<m_frame; ++f)
+        simulate(f);
+    m_rollbackFrom = NO_FRAME;
+
+    const double ms{std::chrono::duration<double, std::milli>(Clock::now() - start).count()};
+    ++m_stats.rollbacks;
+    m_stats.resimFrames += depth;
+    m_stats.maxDepth     = std::max(m_stats.maxDepth, depth);
+    m_stats.resimMs     += ms;
+    m_stats.maxResimMs   = std::max(m_stats.maxResimMs, ms);
+}
+
+// States played with confirmed inputs only are final : remember their checksums
+void RollbackSession::recordSynced()
+{
+    const std::uint32_t last{std::min(m_remoteCount, m_frame)};
+    std::uint32_t f{m_syncedFrame == NO_FRAME ? 0 : m_syncedFrame + 1};
+    for(; f<=last; ++f){
+        const MatchState& s = (f == m_frame) ? m_state : m_snapshots[f % RING];
+        m_hash[f % RING]      = checksum(s);
+        m_hashFrame[f % RING] = f;
+        m_syncedFrame         = f;
+    }
+}
+
+bool RollbackSession::getSyncedChecksum(std::uint32_t frame, std::uint64_t& hash) const
+{
+    if(m_hashFrame[frame % RING] != frame)
+        return false;
+    hash = m_hash[frame % RING];
+    return true;
+}
+
+////////// NETWORK
+void RollbackSession::readDatagram(const std::vector<std::uint8_t>& data)
+{
+    if(data.size() < HEADER || read32(&data[0]) != MAGIC)
+        return;
+
+    const std::uint32_t ack{read32(&data[4])};
+    const std::uint32_t checkedFrame{read32(&data[8])};
+    const std::uint64_t hash{read32(&data[12]) | (static_cast<std::uint64_t>(read32(&data[16])) << 32)};
+    const std::uint32_t first{read32(&data[20])};
+    const std::size_t   count{std::min<std::size_t>(data[24], data.size() - HEADER)};
+
+    m_peerAck = std::max(m_peerAck, std::min(ack, m_localCount));
+
+    // Inputs are taken in order only : a gap waits for a later datagram
+    for(std::size_t k=0; k<count; ++k){
+        const std::uint32_t f{first + static_cast<std::uint32_t>(k)};
+        if(f < m_remoteCount)
+            continue;
+        if(f > m_remoteCount)
+            break;
+
+        const std::int8_t input{static_cast<std::int8_t>(data[HEADER + k])};
+        m_remote[f % RING] = input;
+        if(f < m_frame && m_used[f % RING] != input){
+            ++m_stats.mispredictions;
+            m_rollbackFrom = std::min(m_rollbackFrom, f);
+        }
+        ++m_remoteCount;
+    }
+
+    // The peer's last final state against ours, once per frame
+    std::uint64_t ours{0};
+    if(checkedFrame != NO_FRAME && (m_checkedFrame == NO_FRAME || checkedFrame > m_checkedFrame) &&
+       getSyncedChecksum(checkedFrame, ours)){
+        m_checkedFrame = checkedFrame;
+        ++m_stats.checked;
+        if(ours != hash)
+            ++m_stats.desyncs;
+    }
+}
+
+// Every local input the peer may not have, its last one included
+void RollbackSession::sendInputs(double now)
+{
+    const std::uint32_t first{std::max(m_peerAck, m_localCount > RING ? m_localCount - RING : 0u)};
+    const std::uint32_t count{m_localCount - first};
+
+    std::uint64_t hash{0};
+    const std::uint32_t checked{m_syncedFrame};
+    if(checked != NO_FRAME)
+        getSyncedChecksum(checked, hash);
+
+    std::vector<std::uint8_t> out;
+    out.reserve(HEADER + count);
+    write32(out, MAGIC);
+    write32(out, m_remoteCount);
+    write32(out, checked);
+    write32(out, static_cast<std::uint32_t>(hash));
+    write32(out, static_cast<std::uint32_t>(hash >> 32));
+    write32(out, first);
+    out.push_back(static_cast<std::uint8_t>(count));
+    for(std::uint32_t f=first; f<m_localCount; ++f)
+        out.push_back(static_cast<std::uint8_t>(m_local[f % RING]));
+
+    m_link.send(out, now);
+}
+
+////////// STATS
+void RollbackSession::printStats(std::ostream& os) const
+{
+    const Stats& s = m_stats;
+    const double frames{s.frames > 0 ? static_cast<double>(s.frames) : 1.0};
+    const double rollbacks{s.rollbacks > 0 ? static_cast<double>(s.rollbacks) : 1.0};
+
+    os << std::fixed << std::setprecision(2)
+       << "Player " << (m_config.localPlayer + 1) << " : " << s.frames << " frame(s), "
+       << s.stalls << " stall(s), " << s.mispredictions << " misprediction(s)\n"
+       << "  Rollbacks  : " << s.rollbacks << ", depth mean " << (s.resimFrames / rollbacks)
+       << " max " << s.maxDepth << " frame(s)\n"
+       << "  Resimulate : " << (s.resimFrames / frames) << " frame(s) per frame, "
+       << std::setprecision(3) << ((s.resimMs * 1000.0) / frames) << " us per frame, worst "
+       << (s.maxResimMs * 1000.0) << " us\n"
+       << "  Network    : " << m_link.sent() << " sent, " << m_link.lost() << " lost, "
+       << m_link.received() << " received\n"
+       << "  Checked    : " << s.checked << " frame(s) against the peer, " << s.desyncs << " desync(s)\n";
+}
@@ -0,0 +1,49 @@
+#ifndef BATCHSIM_H
+#define BATCHSIM_H
+
+#include <iostream>
+#include <functional>
+#include <cstdint>
+
+#include "Engine.h"
+
+//////////////////////////////////////////////////////////
+/////// BATCH SIMULATOR
+// Runs many seeded headless games across all cores. A policy picks the
+// next action from the state ; the factory builds a fresh one for each
+// game, from that game's seed, so a policy may keep its own state and the
+// results don't depend on which thread played which game.
+typedef std::function<unsigned(const GameState&)>    Policy;
+typedef std::function<Policy(std::uint64_t gameSeed)> PolicyFactory;
+
+struct BatchConfig
+{
+    unsigned      games{1000};
+    unsigned      threads{0};            // 0 : one per hardware thread
+    std::uint64_t seed{1};               // game i is seeded from (seed, i) only
+    unsigned      maxPieces{10000};      // games still alive after that are stopped
+    unsigned      actionsPerGravity{1};  // policy actions between two gravity ticks
+};
+
+struct BatchReport
+{
+    unsigned      games;
+    unsigned      threads;
+    double        seconds;
+    double        gamesPerSec;
+    std::uint64_t pieces;
+    double        meanLines;
+    double        stdDevLines;
+    unsigned      minLines;
+    unsigned      medianLines;
+    unsigned      maxLines;
+    unsigned      stopped;               // games that hit maxPieces
+};
+
+BatchReport runBatch(const BatchConfig& config, const PolicyFactory& factory);
+void printReport(std::ostream& os, const BatchReport& report);
+
+// Uniform random actions : a baseline, and a stress test for the rules
+Policy randomPolicy(std::uint64_t seed);
+
+#endif // BATCHSIM_H
@@ -0,0 +1,79 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <array>
+#include <cstdint>
+
+//////////////////////////////////////////////////////////
+/////// PIECE MASK
+// One rotation of a piece : one 16-bit mask per row of its box,
+// bit c set when column c of the box is occupied.
+struct PieceMask
+{
+    std::uint16_t rows[4];
+    unsigned      boxSize; // 2 (O), 3 or 4 (I)
+};
+
+struct ClearedLines;
+
+//////////////////////////////////////////////////////////
+/////// BITBOARD
+// Playfield held as one 16-bit mask per row. The playfield columns sit on
+// bits [WALL_LEFT, WALL_LEFT + COLS), every other bit is a wall, so walls,
+// floor and stack are all tested with the same AND.
+// A second row-indexed store keeps the tile id of each cell for the view.
+class Bitboard
+{
+public:
+    static const unsigned      ROWS      = 20;
+    static const unsigned      COLS      = 10;
+    static const unsigned      WALL_LEFT = 3;
+    static const std::uint16_t EMPTY_ROW = static_cast<std::uint16_t>(~(((1u << COLS) - 1u) << WALL_LEFT));
+    static const std::uint16_t FULL_ROW  = 0xFFFF;
+    static const std::uint8_t  NO_TILE   = 0xFF;
+
+    Bitboard();
+
+    void clear();
+
+    // x : column of the piece box's left side (may be negative), y : row of its top
+    bool collide(const PieceMask& piece, int x, int y) const;
+    int  dropDistance(const PieceMask& piece, int x, int y) const;
+    void place(const PieceMask& piece, int x, int y, std::uint8_t tile);
+
+    std::uint32_t fullLines() const;       // bit i set when row i is full
+    unsigned eraseLines(std::uint32_t lines, ClearedLines* cleared = nullptr);
+
+    inline std::uint16_t row(unsigned i) const { return m_rows[i]; }
+    inline bool isSet(unsigned i, unsigned j) const { return (m_rows[i] >> (WALL_LEFT + j)) & 1u; }
+    inline std::uint8_t tile(unsigned i, unsigned j) const { return m_tiles[i][j]; }
+
+private:
+    typedef std::array<std::uint8_t, COLS> TileRow;
+
+    std::array<std::uint16_t, ROWS> m_rows;
+    std::array<TileRow, ROWS>       m_tiles;
+
+    inline std::uint32_t rowAt(int i) const
+    {
+        // Above the field is open, below the floor is a wall
+        if(i < 0) return 0xFFFF0000u | EMPTY_ROW;
+        if(i >= static_cast<int>(ROWS)) return 0xFFFFFFFFu;
+        return 0xFFFF0000u | m_rows[i];
+    }
+};
+
+//////////////////////////////////////////////////////////
+/////// CLEARED LINES
+// What a clear removed, for effects. Fixed size : a piece spans 4 rows at most.
+struct ClearedLines
+{
+    static const unsigned MAX_LINES = 4;
+
+    std::uint32_t                                              mask;  // bit i set when row i was full
+    unsigned                                                   count;
+    std::array<unsigned, MAX_LINES>                            rows;  // top to bottom
+    std::array<std::array<std::uint8_t, Bitboard::COLS>, MAX_LINES> tiles;
+};
+
+#endif // BITBOARD_H
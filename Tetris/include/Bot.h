@@ -0,0 +1,117 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Engine.h"
+#include "BatchSim.h"
+
+//////////////////////////////////////////////////////////
+/////// BOT
+// Autoplayer : enumerates every reachable (rotation, column) drop of the
+// current piece, then of the next one on each resulting board, and keeps
+// the pair with the best board score. The second level is shared between
+// threads and stops when the time budget runs out ; a depth limit instead
+// searches every level asked, whatever the time : same state, same choice.
+// The threads are started once with the bot. A search runs either on the
+// caller (choose), or in the background (start, then poll on later frames).
+// One search at a time : a bot is not shared between callers.
+struct BotWeights
+{
+    float height{-0.510066f};     // sum of column heights
+    float lines{0.760666f};       // lines cleared by the two drops
+    float holes{-0.35663f};       // empty cells under the stack
+    float bumpiness{-0.184483f};  // sum of height steps between columns
+};
+
+struct Placement
+{
+    unsigned rotations;  // 0 : none, 1 : cw, 2 : cw cw, 3 : ccw
+    int      shift;      // columns to move once rotated (negative : left)
+    float    score;
+    bool     valid;
+};
+
+class Bot
+{
+public:
+    typedef std::chrono::microseconds Budget;
+
+    explicit Bot(unsigned threads = 0, const BotWeights& weights = BotWeights());
+    ~Bot();
+
+    Bot(const Bot&) = delete;
+    Bot& operator=(const Bot&) = delete;
+
+    Placement choose(const GameState& state, Budget budget = Budget(50000));
+    // depth 1 : current piece only, 2 : with the next one
+    Placement choose(const GameState& state, unsigned depth);
+
+    // Background search : start() never waits, poll() gives the placement
+    // of the last search started once it is done (older ones are dropped)
+    void start(const GameState& state, Budget budget);
+    bool poll(Placement& placement);
+
+    // Actions reaching a placement, ending with a hard drop
+    static std::size_t plan(const Placement& placement, std::array<unsigned, 16>& actions);
+
+    float evaluate(const Bitboard& board, unsigned linesCleared) const;
+
+    // Depth-limited : batch results don't depend on the machine load
+    Policy asPolicy(unsigned depth = 2) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Candidate
+    {
+        Placement placement;
+        GameState dropped;   // board after the first drop
+        unsigned  lines;     // lines cleared by the first drop
+        float     score;     // best two-drop score found so far
+        bool      deep;      // level 2 done : score is the two-drop one
+    };
+
+    unsigned   m_threads;
+    BotWeights m_weights;
+
+    std::mutex              m_mutex;
+    bool                    m_quit;          // searcher first, helpers once it is gone
+    bool                    m_quitHelpers;
+
+    // Level 2 : helpers join the thread running the search
+    std::vector<std::thread> m_helpers;
+    std::condition_variable m_levelStart;
+    std::condition_variable m_levelEnd;
+    std::uint64_t           m_level;         // second levels started
+    unsigned                m_levelLeft;     // helpers still in it
+    std::vector<Candidate>  m_candidates;
+    std::atomic<std::size_t> m_nextCandidate;
+    unsigned                m_rootLines;
+    Clock::time_point       m_deadline;
+
+    // Background search (thread started by the first start())
+    std::thread             m_searcher;
+    std::condition_variable m_wake;
+    GameState               m_job;
+    Clock::time_point       m_jobDeadline;
+    std::uint64_t           m_jobId;         // searches started
+    std::uint64_t           m_takenId;       // last one the searcher took
+    std::uint64_t           m_resultId;      // last one it finished
+    Placement               m_result;
+
+    Placement search(const GameState& state, unsigned depth, Clock::time_point deadline);
+    void secondLevel();
+    void helperLoop();
+    void searchLoop();
+};
+
+#endif // BOT_H
@@ -0,0 +1,64 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Bitboard.h"
+#include "Tetromino.h"
+
+//////////////////////////////////////////////////////////
+/////// ENGINE
+// Every Tetris rule, free of SFML and of globals : a game is a plain
+// GameState value and the only way to change it is an Action.
+// The window version and the batch simulator both drive the same code.
+const int      spawnCol{3};
+const float    delayMin{0.1f};
+const float    delayMax{1.f};
+
+enum action{
+    NONE,
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    SOFT_DROP,
+    ROTATE_CW,
+    ROTATE_CCW,
+    HARD_DROP,
+    GRAVITY,     // one gravity tick : falls one row, or locks
+    ACTION_MAX
+};
+
+struct Piece
+{
+    std::size_t id;
+    unsigned    rot;
+    int         x;   // column of the box's left side
+    int         y;   // row of the box's top side
+};
+
+struct GameState
+{
+    Bitboard      board;
+    Piece         piece;
+    Piece         next;
+    std::uint64_t rng;        // randomizer state, the whole game follows from the seed
+    unsigned      lines;
+    unsigned      pieces;     // pieces locked so far
+    float         delay;      // seconds between two gravity ticks
+    bool          gameOver;
+    ClearedLines  lastClear;  // rows cleared by the last step (count == 0 if none)
+};
+
+inline const PieceMask& maskOf(const Piece& p) { return maskOf(p.id, p.rot); }
+
+GameState newGame(std::uint64_t seed);
+
+// (state, action) -> state
+GameState step(const GameState& state, unsigned act);
+// Same, in place. Returns false if the action had no effect.
+bool apply(GameState& state, unsigned act);
+
+// FNV-1a over everything that defines the game (not the last clear record)
+std::uint64_t stateHash(const GameState& state);
+
+#endif // ENGINE_H
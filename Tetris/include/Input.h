@@ -0,0 +1,99 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include <SFML/Window.hpp>
+
+#include "Engine.h"
+
+//////////////////////////////////////////////////////////
+/////// INPUT SAMPLER
+// Polls the keyboard on its own thread at a fixed rate, so held keys
+// repeat with the same DAS/ARR whatever the frame time and the OS repeat.
+// Actions are queued with the time their key state was seen ; the game
+// loop drains them, applies each one in the step of its time and reports
+// the input to display latency.
+typedef std::chrono::steady_clock InputClock;
+
+struct InputConfig
+{
+    float    das{0.167f};           // delayed auto shift : held time before repeat (s)
+    float    arr{0.033f};           // auto repeat rate : time between repeats (s), 0 : to the wall
+    float    softDropFactor{20.f};  // soft drop is this many times faster than gravity
+    unsigned sampleRate{1000};      // keyboard polls per second
+
+    sf::Keyboard::Key left{sf::Keyboard::Q};
+    sf::Keyboard::Key right{sf::Keyboard::D};
+    sf::Keyboard::Key softDrop{sf::Keyboard::S};
+    sf::Keyboard::Key rotateCW{sf::Keyboard::R};
+    sf::Keyboard::Key rotateCCW{sf::Keyboard::E};
+    sf::Keyboard::Key hardDrop{sf::Keyboard::Z};
+};
+
+struct InputEvent
+{
+    unsigned              act;
+    InputClock::time_point stamp;
+};
+
+class InputSampler
+{
+public:
+    explicit InputSampler(const InputConfig& config = InputConfig());
+    ~InputSampler();
+
+    InputSampler(const InputSampler&) = delete;
+    InputSampler& operator=(const InputSampler&) = delete;
+
+    // Off : keys count as released and nothing is queued (game over, no focus...)
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    // Soft drop repeat follows the current gravity
+    void setGravityDelay(float delay) { m_gravityDelay = delay; }
+
+    // Moves the queued actions into 'out' (cleared first)
+    void drain(std::vector<InputEvent>& out);
+
+    // Latency of an action once the frame showing it is displayed : the
+    // last LATENCY_RING ones are kept for the percentiles
+    static const std::size_t LATENCY_RING{1 << 12};
+    void noteShown(const InputEvent& event);
+    void printLatency(std::ostream& os) const;
+
+private:
+    struct HeldKey
+    {
+        bool                  down;
+        InputClock::time_point next;    // next repeat
+    };
+
+    const InputConfig       m_config;
+    std::atomic<bool>       m_enabled;
+    std::atomic<float>      m_gravityDelay;
+    std::atomic<bool>       m_quit;
+
+    std::mutex              m_mutex;
+    std::vector<InputEvent> m_queue;
+
+    // Sampler thread only
+    HeldKey                 m_left, m_right, m_softDrop;
+    bool                    m_rotateCW, m_rotateCCW, m_hardDrop;
+    unsigned                m_lastShift;    // last of left/right pressed wins
+
+    // Game loop only
+    std::vector<float>      m_latencies;    // microseconds, ring of LATENCY_RING
+    std::size_t             m_latencyCount; // actions noted since the start
+
+    std::thread             m_thread;
+
+    void run();
+    void sample(InputClock::time_point now, std::vector<InputEvent>& out);
+    void release();
+};
+
+#endif // INPUT_H
@@ -0,0 +1,75 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Engine.h"
+
+//////////////////////////////////////////////////////////
+/////// REPLAY
+// A game is its seed plus the actions the engine applied, gravity included,
+// so replaying the log gives back the exact same game at any speed.
+// File : "TRPL", version, seed, event count, final tick, final state hash,
+// then one varint per event : (tick delta << 3) | action.
+const unsigned TICK_RATE{60};   // ticks per second of the timestamps
+
+class ReplayRecorder
+{
+public:
+    explicit ReplayRecorder(std::uint64_t seed = 0);
+
+    void reset(std::uint64_t seed);
+    void record(std::uint32_t tick, unsigned act);
+    bool save(const std::string& fileName, const GameState& finalState) const;
+
+    inline std::uint64_t getSeed() const { return m_seed; }
+    inline std::uint32_t getCount() const { return m_count; }
+
+private:
+    std::uint64_t             m_seed;
+    std::uint32_t             m_count;
+    std::uint32_t             m_lastTick;
+    std::vector<std::uint8_t> m_events;
+};
+
+class ReplayPlayer
+{
+public:
+    ReplayPlayer();
+
+    bool load(const std::string& fileName);
+
+    void rewind();
+    // Next action stamped at or before 'tick', if any
+    bool next(std::uint32_t tick, unsigned& act);
+    inline bool finished() const { return m_played >= m_count; }
+
+    // Plays everything left as fast as possible
+    GameState runHeadless();
+    bool verify(const GameState& state) const { return stateHash(state) == m_finalHash; }
+
+    inline std::uint64_t getSeed() const { return m_seed; }
+    inline std::uint32_t getCount() const { return m_count; }
+    inline std::uint32_t getFinalTick() const { return m_finalTick; }
+    inline std::uint64_t getFinalHash() const { return m_finalHash; }
+
+private:
+    std::uint64_t             m_seed;
+    std::uint32_t             m_count;
+    std::uint32_t             m_finalTick;
+    std::uint64_t             m_finalHash;
+    std::vector<std::uint8_t> m_events;
+
+    // Cursor
+    std::size_t               m_offset;
+    std::uint32_t             m_played;
+    std::uint32_t             m_tick;
+    bool                      m_pending;
+    unsigned                  m_pendingAct;
+
+    bool decode(std::uint32_t& tick, unsigned& act);
+};
+
+#endif // REPLAY_H
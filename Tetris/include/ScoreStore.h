@@ -0,0 +1,69 @@
+#ifndef SCORESTORE_H
+#define SCORESTORE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//////////////////////////////////////////////////////////
+/////// SCORE STORE
+// Every finished game, kept in memory with a sorted top-N index and a
+// running sum of the last games, so queries never touch the disk.
+// File : "TSCO", version, count, then count x (lines u32, pieces u32, time i64),
+// little-endian. A writer thread saves a snapshot to "<file>.tmp" then renames
+// it over the file : adding a score on the game loop only costs a push_back.
+struct ScoreEntry
+{
+    std::uint32_t lines;
+    std::uint32_t pieces;
+    std::int64_t  time;     // std::time_t of the game over
+};
+
+class ScoreStore
+{
+public:
+    static const std::size_t TOP_MAX{10};
+    static const std::size_t ROLLING{10};    // games in the rolling average
+
+    explicit ScoreStore(const std::string& fileName);
+    ~ScoreStore();
+
+    ScoreStore(const ScoreStore&) = delete;
+    ScoreStore& operator=(const ScoreStore&) = delete;
+
+    // Reads the binary file, or imports the old text log "score asctime" once.
+    // False if there is neither, or if the file is damaged (set aside then).
+    bool load(const std::string& legacyFile = "");
+    void add(unsigned lines, unsigned pieces);
+
+    inline const std::vector<ScoreEntry>& top() const { return m_top; }
+    inline unsigned best() const { return m_top.empty() ? 0 : m_top.front().lines; }
+    float rollingAverage() const;
+    inline std::size_t count() const { return m_entries.size(); }
+    inline const ScoreEntry* last() const { return m_entries.empty() ? nullptr : &m_entries.back(); }
+
+private:
+    std::string             m_fileName;
+    std::vector<ScoreEntry> m_entries;
+    std::vector<ScoreEntry> m_top;
+    std::uint64_t           m_rollingSum;
+
+    // Writer
+    std::thread             m_writer;
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::vector<ScoreEntry> m_pending;       // entries not handed to the writer yet
+    bool                    m_dirty;
+    bool                    m_quit;
+
+    void index(const ScoreEntry& entry);
+    void writerLoop();
+    bool importLegacy(const std::string& legacyFile);
+    bool setAside();
+    static bool writeFile(const std::string& fileName, const std::vector<ScoreEntry>& entries);
+};
+
+#endif // SCORESTORE_H
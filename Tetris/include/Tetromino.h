@@ -0,0 +1,120 @@
+#ifndef TETROMINO_H
+#define TETROMINO_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Bitboard.h"
+
+//////////////////////////////////////////////////////////
+/////// TETROMINOES
+// Each piece is four cell coordinates inside its box, for each of the four
+// SRS orientations (0, R, 2, L). Everything is built at compile time :
+// rotating is a table lookup, never an allocation.
+enum tetromino{
+    T,
+    J,
+    L,
+    S,
+    Z,
+    I,
+    O,
+    TETROMINO_MAX
+};
+
+struct CellOffset
+{
+    int x;
+    int y;
+};
+
+struct Rotation
+{
+    CellOffset cells[4];
+    PieceMask  mask;
+};
+
+struct Tetromino
+{
+    unsigned boxSize;
+    Rotation rotations[4];
+};
+
+//////////////////////////////////////////////////////////
+/////// BUILD (spawn orientation, rotated clockwise in its box)
+constexpr Tetromino makeTetromino(unsigned boxSize, CellOffset a, CellOffset b, CellOffset c, CellOffset d)
+{
+    Tetromino t{};
+    t.boxSize = boxSize;
+    t.rotations[0].cells[0] = a;
+    t.rotations[0].cells[1] = b;
+    t.rotations[0].cells[2] = c;
+    t.rotations[0].cells[3] = d;
+
+    for(unsigned r=1; r<4; ++r){
+        for(unsigned k=0; k<4; ++k){
+            const CellOffset p = t.rotations[r-1].cells[k];
+            // Clockwise : (x, y) -> (n-1-y, x)
+            t.rotations[r].cells[k] = CellOffset{static_cast<int>(boxSize) - 1 - p.y, p.x};
+        }
+    }
+
+    for(unsigned r=0; r<4; ++r){
+        t.rotations[r].mask.boxSize = boxSize;
+        for(unsigned k=0; k<4; ++k){
+            const CellOffset p = t.rotations[r].cells[k];
+            t.rotations[r].mask.rows[p.y] = static_cast<std::uint16_t>(t.rotations[r].mask.rows[p.y] | (1u << p.x));
+        }
+    }
+
+    return t;
+}
+
+constexpr Tetromino TETROMINOES[TETROMINO_MAX]{
+    makeTetromino(3, {1, 0}, {0, 1}, {1, 1}, {2, 1}),  // T
+    makeTetromino(3, {0, 0}, {0, 1}, {1, 1}, {2, 1}),  // J
+    makeTetromino(3, {2, 0}, {0, 1}, {1, 1}, {2, 1}),  // L
+    makeTetromino(3, {1, 0}, {2, 0}, {0, 1}, {1, 1}),  // S
+    makeTetromino(3, {0, 0}, {1, 0}, {1, 1}, {2, 1}),  // Z
+    makeTetromino(4, {0, 1}, {1, 1}, {2, 1}, {3, 1}),  // I
+    makeTetromino(2, {0, 0}, {1, 0}, {0, 1}, {1, 1})   // O
+};
+
+//////////////////////////////////////////////////////////
+/////// SRS WALL KICKS
+// Offsets tried in order when rotating from orientation r clockwise.
+// SRS tables are y-up, these are already flipped for our y-down rows.
+// Counter-clockwise from r+1 uses the same offsets negated.
+const std::size_t KICK_TESTS = 5;
+
+constexpr CellOffset KICKS_JLSTZ[4][KICK_TESTS]{
+    {{0, 0}, {-1, 0}, {-1, -1}, {0,  2}, {-1,  2}},  // 0 -> R
+    {{0, 0}, { 1, 0}, { 1,  1}, {0, -2}, { 1, -2}},  // R -> 2
+    {{0, 0}, { 1, 0}, { 1, -1}, {0,  2}, { 1,  2}},  // 2 -> L
+    {{0, 0}, {-1, 0}, {-1,  1}, {0, -2}, {-1, -2}}   // L -> 0
+};
+
+constexpr CellOffset KICKS_I[4][KICK_TESTS]{
+    {{0, 0}, {-2, 0}, { 1, 0}, {-2,  1}, { 1, -2}},  // 0 -> R
+    {{0, 0}, {-1, 0}, { 2, 0}, {-1, -2}, { 2,  1}},  // R -> 2
+    {{0, 0}, { 2, 0}, {-1, 0}, { 2, -1}, {-1,  2}},  // 2 -> L
+    {{0, 0}, { 1, 0}, {-2, 0}, { 1,  2}, {-2, -1}}   // L -> 0
+};
+
+constexpr CellOffset NO_KICK[KICK_TESTS]{{0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}};
+
+//////////////////////////////////////////////////////////
+/////// KICK LOOKUP
+// from : orientation before a clockwise turn (use (to) and negate for counter-clockwise)
+constexpr const CellOffset* kicksFor(std::size_t id, unsigned from)
+{
+    return (id == tetromino::O) ? NO_KICK :
+           (id == tetromino::I) ? KICKS_I[from % 4] : KICKS_JLSTZ[from % 4];
+}
+
+inline const PieceMask& maskOf(std::size_t id, unsigned rot)
+{
+    return TETROMINOES[id].rotations[rot % 4].mask;
+}
+
+#endif // TETROMINO_H
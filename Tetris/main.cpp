@@ -4,502 +4,375 @@
 #include <cmath>
 #include <cassert>
 #include <algorithm>
-#include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <ctime>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 
-#include "include/Outils.h"
+#include "include/Engine.h"
+#include "include/BatchSim.h"
+#include "include/Bot.h"
+#include "include/Replay.h"
+#include "include/ScoreStore.h"
+#include "include/Input.h"
+#include "../Utilities/SpriteBatch.hpp"
+#include "../Utilities/Hud.hpp"
+#include "../Utilities/GameLoop.hpp"
+#include "../Utilities/Arguments.hpp"
+#include "../Utilities/Random.hpp"
+#define ASSETLOADER_NO_AUDIO
+#include "../Utilities/AssetLoader.hpp"
 
 //////////////////////////////////////////////////////////
-/////// ENUM DIRECTION
-enum dir{
-    DOWN,
-    LEFT,
-    RIGHT,
-    DIR_MAX
-};
-//////////////////////////////////////////////////////////
-/////// PATRONS OF PIECE
-// Pattern default : {0, 0, 0, 0, 0, 0, 0, 0, 0} (9);
-// Pattern default : {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0} (16);
-const std::vector<std::vector<unsigned>> patrons{{0, 1, 0, 1, 1, 1, 0, 0, 0},  // T
-                                                 {1, 0, 0, 1, 1, 1, 0, 0, 0},  // J
-                                                 {0, 0, 1, 1, 1, 1, 0, 0, 0},  // L
-                                                 {0, 1, 1, 1, 1, 0, 0, 0, 0},  // S
-                                                 {1, 1, 0, 0, 1, 1, 0, 0, 0},  // Z
-                                                 {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0},  // I
-                                                 {1, 1, 1, 1}}; // O
+/////// VIEW
 const sf::Vector2f originField{120.f, 40.f};
-const unsigned     rowsGrid{20};
-const unsigned     colsGrid{10};
+const unsigned     rowsGrid{Bitboard::ROWS};
+const unsigned     colsGrid{Bitboard::COLS};
 const float        size_tile{20};
-const float        delayMin{0.1f};
-const float        delayMax{1.f};
+const float        lineFlashDuration{0.25f};
 const unsigned     SCREEN_X{500};
 const unsigned     SCREEN_Y{480};
 
-float              delay{delayMax};
-unsigned           line_ctr{0};
+// Slots of the play layer (one batch, one draw call) : background,
+// playfield, falling piece, next piece, line flash ghosts
+const std::size_t  SLOT_CANVA{0};
+const std::size_t  SLOT_GRID{1};
+const std::size_t  SLOT_PIECE{SLOT_GRID + (rowsGrid*colsGrid)};
+const std::size_t  SLOT_NEXT{SLOT_PIECE + 4};
+const std::size_t  SLOT_FLASH{SLOT_NEXT + 4};
+const std::size_t  SLOT_COUNT{SLOT_FLASH + (ClearedLines::MAX_LINES*colsGrid)};
 
 //////////////////////////////////////////////////////////
-/////// CREATE PIECE
-std::vector<sf::Sprite> createPiece(const std::vector<unsigned>&, const sf::Sprite&);
-std::vector<sf::Sprite> createPiece(const std::vector<unsigned>& patron, const sf::Sprite& s)
+/////// LINE CLEAR EFFECT
+// Ghost of the cleared rows fading out over the field. The board is
+// already compacted : the effect only draws, it never holds the game.
+struct LineFlash
 {
-    double sizeMatrice{sqrt(patron.size())};
-    assert(round(sizeMatrice) == sizeMatrice && "Piece must be a squared matrice.");
-    sizeMatrice = static_cast<std::size_t>(sizeMatrice);
-
-    std::vector<sf::Sprite> tmp;
-
-    for(std::size_t i=0; i<sizeMatrice; ++i){
-        for(std::size_t j=0; j<sizeMatrice; ++j){
-            if(patron[(i*sizeMatrice)+j] == 1){
-                tmp.push_back(s);
-            }
-            else{
-                tmp.push_back(sf::Sprite());
-            }
-
-            tmp.back().setPosition((j*s.getGlobalBounds().width)+(originField.x + (3*size_tile)),
-                                   (i*s.getGlobalBounds().height)+originField.y);
-        }
-    }
+    ClearedLines lines;
+    float        elapsed;
+    bool         active;
+};
 
-    return tmp;
-}
-//////////////////////////////////////////////////////////
-/////// MOVE PIECE
-void movePiece(std::vector<sf::Sprite>&, int, int);
-void movePiece(std::vector<sf::Sprite>& v, int dx = 0, int dy = 0)
+void startLineFlash(LineFlash&, const ClearedLines&);
+void startLineFlash(LineFlash& flash, const ClearedLines& lines)
 {
-    for(auto&& x : v){
-        x.move(size_tile*dx, size_tile*dy);
-    }
-}
-//////////////////////////////////////////////////////////
-/////// CHECK EMPTY SPRITES OUTSIDE PLAYFIELD (used in rotation)
-bool checkSpriteOut(const std::vector<sf::Sprite>&);
-bool checkSpriteOut(const std::vector<sf::Sprite>& piece)
-{
-    for(const auto& part : piece){
-        if(part.getPosition().x < originField.x)
-            return true;
-        if(part.getPosition().x >= (colsGrid*size_tile)+originField.x)
-            return true;
-    }
+    if(lines.count == 0)
+        return;
 
-    return false;
+    flash.lines   = lines;
+    flash.elapsed = 0.f;
+    flash.active  = true;
 }
-//////////////////////////////////////////////////////////
-/////// CHECK EMPTY SPRITES INTERSECT CONCRETE SPRITES (used in event keyboard)
-bool checkSpriteIntersect(const std::vector<sf::Sprite>&, const std::vector<sf::Sprite>&);
-bool checkSpriteIntersect(const std::vector<sf::Sprite>& piece, const std::vector<sf::Sprite>& gridSprite)
-{
-    for(const auto& part : piece){
-        for(const auto& sprite : gridSprite){
-            if(sprite.getTexture() != nullptr){
-                if(part.getPosition().x == sprite.getPosition().x &&
-                   part.getPosition().y == sprite.getPosition().y)
-                {
-                    return true;
-                }
-            }
-        }
-    }
 
-    return false;
-}
-//////////////////////////////////////////////////////////
-/////// ROTATE PIECE (only clockwise for the moment)
-void rotatePiece(std::vector<sf::Sprite>&);
-void rotatePiece(std::vector<sf::Sprite>& piece)
+void updateLineFlash(LineFlash&, float);
+void updateLineFlash(LineFlash& flash, float dt)
 {
-    if(!checkSpriteOut(piece)){
-
-        double sizeMatrice{sqrt(piece.size())};
-        unsigned rows{static_cast<unsigned>(sizeMatrice)};
-        unsigned cols{rows};
+    if(!flash.active)
+        return;
 
-        std::vector<sf::Sprite> tmp;
-
-        // Start Reading bottom-left
-        std::size_t start{piece.size() - cols};
+    flash.elapsed += dt;
+    if(flash.elapsed >= lineFlashDuration)
+        flash.active = false;
+}
 
-        for(std::size_t i=start; i<piece.size(); ++i){
-            std::size_t index{i};
-            for(unsigned j=0; j<rows; ++j){
-                tmp.push_back(piece[index]); // Linear push to tmp
-                index -= cols;
-            }
-        }
+void updateLineFlashQuads(const LineFlash&, const std::vector<sf::IntRect>&, SpriteBatch&);
+void updateLineFlashQuads(const LineFlash& flash, const std::vector<sf::IntRect>& tileSet, SpriteBatch& batch)
+{
+    const sf::Uint8 alpha{static_cast<sf::Uint8>(255.f * (1.f - (flash.elapsed / lineFlashDuration)))};
 
-        for(unsigned i=0; i<rows; ++i){
-            for(unsigned j=0; j<cols; ++j){
-                tmp[(i*cols)+j].setPosition(piece[(i*cols)+j].getPosition());
+    for(unsigned l=0; l<ClearedLines::MAX_LINES; ++l){
+        for(unsigned j=0; j<colsGrid; ++j){
+            const std::size_t slot{SLOT_FLASH + (l*colsGrid) + j};
+            const std::uint8_t tile{flash.lines.tiles[l][j]};
+            if(!flash.active || l >= flash.lines.count || tile == Bitboard::NO_TILE){
+                batch.hide(slot);
+                continue;
             }
+            batch.set(slot, sf::FloatRect{(j*size_tile)+originField.x, (flash.lines.rows[l]*size_tile)+originField.y,
+                                          size_tile, size_tile},
+                      tileSet[tile], sf::Color(255, 255, 255, alpha));
         }
-
-        piece = tmp;
     }
 }
 //////////////////////////////////////////////////////////
-/////// COLLIDE PLAYFIELD'S BORDERS
-bool collidePlayField(const std::vector<sf::Sprite>&, float, unsigned);
-bool collidePlayField(const std::vector<sf::Sprite>& piece, float playFieldBorder, unsigned dir = dir::DOWN)
+/////// PIECE QUADS (view of a piece whose box top-left is at boxOrigin, 4 slots)
+void pieceQuads(const PieceMask&, const sf::IntRect&, const sf::Vector2f&, SpriteBatch&, std::size_t);
+void pieceQuads(const PieceMask& mask, const sf::IntRect& tile, const sf::Vector2f& boxOrigin,
+                SpriteBatch& batch, std::size_t firstSlot)
 {
-    bool isCollide{false};
+    std::size_t slot{firstSlot};
 
-    for(const auto& s : piece){
-        if(s.getTexture() != nullptr){
-            if(dir == dir::DOWN){
-                isCollide = (s.getGlobalBounds().top + s.getGlobalBounds().height >= playFieldBorder);
+    for(unsigned i=0; i<mask.boxSize; ++i){
+        for(unsigned j=0; j<mask.boxSize; ++j){
+            if(((mask.rows[i] >> j) & 1u) && slot < firstSlot + 4){
+                batch.set(slot++, sf::FloatRect{boxOrigin.x + (j*size_tile), boxOrigin.y + (i*size_tile), size_tile, size_tile},
+                          tile);
             }
-            if(dir == dir::LEFT){
-                isCollide = (s.getGlobalBounds().left <= playFieldBorder);
-            }
-            if(dir == dir::RIGHT){
-                isCollide = (s.getGlobalBounds().left + s.getGlobalBounds().width >= playFieldBorder);
-            }
-
-            if(isCollide)
-                break;
         }
     }
-
-    return isCollide;
+    while(slot < firstSlot + 4)
+        batch.hide(slot++);
 }
 //////////////////////////////////////////////////////////
-/////// COLLIDE PIECE TO PIECE
-bool collidePiece(const std::vector<sf::Sprite>&, std::vector<sf::Sprite>&, int);
-bool collidePiece(const std::vector<sf::Sprite>& gridSprites, std::vector<sf::Sprite>& piece, int dir = dir::DOWN)
+/////// UPDATE GRID QUADS (view of the bitboard, unchanged cells aren't rewritten)
+void updateGridQuads(const Bitboard&, const std::vector<sf::IntRect>&, SpriteBatch&);
+void updateGridQuads(const Bitboard& board, const std::vector<sf::IntRect>& tileSet, SpriteBatch& batch)
 {
-    for(auto&& part : piece){
-        for(auto&& concretePart : gridSprites){
-            if(part.getTexture() != nullptr && concretePart.getTexture() != nullptr){
-                // BOTTOM-TOP
-                if(dir == dir::DOWN){
-                    if(part.getPosition().x == concretePart.getPosition().x){
-                        if(part.getPosition().y+part.getGlobalBounds().height == concretePart.getPosition().y){
-                            return true;
-                        }
-                    }
-                }
-                // LEFT
-                if(dir == dir::LEFT){
-                    if(part.getPosition().y == concretePart.getPosition().y){
-                        if(part.getPosition().x == concretePart.getPosition().x + concretePart.getGlobalBounds().width){
-                            return true;
-                        }
-                    }
-                }
-                // RIGHT
-                if(dir == dir::RIGHT){
-                    if(part.getPosition().y == concretePart.getPosition().y){
-                        if(part.getPosition().x + part.getGlobalBounds().width == concretePart.getPosition().x){
-                            return true;
-                        }
-                    }
-                }
-            }
+    for(unsigned i=0; i<rowsGrid; ++i){
+        const bool empty{board.row(i) == Bitboard::EMPTY_ROW};
+        for(unsigned j=0; j<colsGrid; ++j){
+            const std::size_t slot{SLOT_GRID + (i*colsGrid) + j};
+            if(!empty && board.isSet(i, j))
+                batch.set(slot, sf::FloatRect{(j*size_tile)+originField.x, (i*size_tile)+originField.y, size_tile, size_tile},
+                          tileSet[board.tile(i, j)]);
+            else
+                batch.hide(slot);
         }
     }
-
-    return false;
-}
-//////////////////////////////////////////////////////////
-/////// RANDOM ID
-std::size_t randomID(int, int);
-std::size_t randomID(int minVal, int maxVal)
-{
-    assert((minVal>=0 && maxVal>=0) && "Index can't be negative.");
-    assert((minVal<=static_cast<int>(patrons.size()) &&
-            maxVal<=static_cast<int>(patrons.size())) &&
-           "Index max out of range");
-
-    return static_cast<std::size_t>(Outils::rollTheDice(minVal, maxVal));
 }
 //////////////////////////////////////////////////////////
-//// MOVE ACTIVE PIECE INTO GRID
-void movePieceToGrid(std::vector<sf::Sprite>& piece, std::vector<bool>&, std::vector<sf::Sprite>&);
-void movePieceToGrid(std::vector<sf::Sprite>& piece, std::vector<bool>& grid, std::vector<sf::Sprite>& gridSprite)
+/////// UPDATE NEXT PIECE TO SHOW
+void updateNextPieceShow(const Piece&, const std::vector<sf::IntRect>&, SpriteBatch&);
+void updateNextPieceShow(const Piece& nextPiece, const std::vector<sf::IntRect>& tileSet, SpriteBatch& batch)
 {
-    float x{0.f}, y{0.f};
-    std::size_t i{0}, j{0};
-    std::size_t index{0};
-
-    for(auto&& part : piece){
+    const PieceMask& mask{maskOf(nextPiece)};
+    sf::Vector2f boxOrigin{350.f, 250.f};
 
-        const float sizePart{part.getGlobalBounds().width};
-        x = part.getPosition().x - originField.x;
-        y = part.getPosition().y - originField.y;
-        i = static_cast<std::size_t>(y / sizePart);
-        j = static_cast<std::size_t>(x / sizePart);
-        index = (i*colsGrid) + j;
+    if(mask.boxSize == 2)
+        boxOrigin = sf::Vector2f(360.f, 250.f);
+    else if(mask.boxSize == 4)
+        boxOrigin = sf::Vector2f(340.f, 240.f);
 
-        if(part.getTexture() != nullptr){
-            grid[index] = true;
-        }
-        else{
-            grid[index] = false;
-        }
-
-        gridSprite[index] = part;
-    }
-
-    piece.clear();
-}
-//////////////////////////////////////////////////////////
-/////// LAUNCH NEXT PIECE
-void launchNextPiece(std::vector<sf::Sprite>& activePiece, std::vector<sf::Sprite>&, const std::vector<sf::Sprite>);
-void launchNextPiece(std::vector<sf::Sprite>& activePiece, std::vector<sf::Sprite>& nextPiece, const std::vector<sf::Sprite> tileSet)
-{
-    activePiece = std::move(nextPiece);
-    nextPiece.clear();
-    std::size_t randIndex{randomID(0, 6)};
-    nextPiece = createPiece(patrons[randIndex], tileSet[randIndex]);
-}
-//////////////////////////////////////////////////////////
-/////// CHECK LINES
-std::vector<std::size_t> checkFullLines(const std::vector<bool>&);
-std::vector<std::size_t> checkFullLines(const std::vector<bool>& grid)
-{
-    std::vector<std::size_t> tmp;
-
-    for(std::size_t i=0; i<(rowsGrid*colsGrid); i+=colsGrid){
-        auto it_begin = grid.begin() + i;
-        auto it_end   = it_begin + colsGrid;
-        auto it_find  = std::find(it_begin, it_end, false);
-        if(it_find == it_end){
-            tmp.push_back(i);
-        }
-    }
-
-    return tmp;
+    pieceQuads(mask, tileSet[nextPiece.id], boxOrigin, batch, SLOT_NEXT);
 }
 //////////////////////////////////////////////////////////
-/////// MOVE DOWN LINES : called at the end of eraseLines()
-void moveDownLines(std::vector<bool>& grid, std::vector<sf::Sprite>&, std::size_t);
-void moveDownLines(std::vector<bool>& grid, std::vector<sf::Sprite>& gridSprite, std::size_t lineErased)
+/////// SCORE BOARD (Game Over screen, built once per game over)
+void updateScoreBoard(sf::Text&, sf::Text&, const ScoreStore&);
+void updateScoreBoard(sf::Text& summary, sf::Text& table, const ScoreStore& scores)
 {
-    std::size_t startCopy{0};
-    std::size_t endCopy{lineErased};
-
-    for(std::size_t i=0; i<(rowsGrid*colsGrid); i+=colsGrid){
-        auto it_begin = grid.begin() + i;
-        auto it_end   = it_begin + colsGrid;
-        auto it_find  = std::find(it_begin, it_end, true);
-        if(it_find != it_end){
-            startCopy = i;
-            break;
-        }
-    }
-
-    std::vector<bool> tmp_bool;
-    std::vector<sf::Sprite> tmp_sprites;
-
-    for(unsigned i=startCopy; i<endCopy; ++i){
-        tmp_bool.push_back(grid[i]);
-        tmp_sprites.push_back(gridSprite[i]);
-    }
-    for(unsigned i=startCopy; i<endCopy; ++i){
-        grid[i] = false;
-        gridSprite[i] = sf::Sprite();
-    }
-    for(unsigned i=0; i<tmp_bool.size(); ++i){
-        grid[(startCopy+colsGrid)+i] = tmp_bool[i];
-        gridSprite[(startCopy+colsGrid)+i] = tmp_sprites[i];
-        gridSprite[(startCopy+colsGrid)+i].move(0, size_tile);
-    }
-}
-//////////////////////////////////////////////////////////
-/////// ERASE LINES
-void eraseLines(std::vector<bool>&, std::vector<sf::Sprite>&);
-void eraseLines(std::vector<bool>& grid, std::vector<sf::Sprite>& gridSprite)
-{
-    std::vector<std::size_t> linesToErase = checkFullLines(grid);
-
-    for(auto&& line : linesToErase){
-        for(std::size_t i=line; i<line+colsGrid; ++i){
-            grid[i] = false;
-        }
-
-        ++line_ctr;
-
-        if(line_ctr%5 == 0){
-
-            if(delay>0.5f)
-                delay -= 0.075f;
+    std::ostringstream oss;
+    oss << "LAST " << (scores.last() ? scores.last()->lines : 0)
+        << "   BEST " << scores.best()
+        << "   AVG " << std::fixed << std::setprecision(1) << scores.rollingAverage();
+    summary.setString(oss.str());
+    summary.setOrigin(summary.getGlobalBounds().width / 2.f, 0.f);
+
+    // Top 10 on two columns of five
+    const auto& top = scores.top();
+    std::ostringstream tss;
+    for(std::size_t i=0; i<5; ++i){
+        for(std::size_t c=0; c<2; ++c){
+            const std::size_t rank{i + c*5};
+            tss << std::setw(2) << (rank+1) << ". " << std::setw(5);
+            if(rank < top.size())
+                tss << top[rank].lines;
             else
-                delay -=0.05;
-
-            if(delay<delayMin)
-                delay = delayMin;
+                tss << '-';
+            tss << (c == 0 ? "        " : "\n");
         }
-
-        moveDownLines(grid, gridSprite, line);
     }
+    table.setString(tss.str());
+    table.setOrigin(table.getGlobalBounds().width / 2.f, 0.f);
 }
-//////////////////////////////////////////////////////////
-/////// UPDATE NEXT PIECE TO SHOW
-void updateNextPieceShow(const std::vector<sf::Sprite>&, std::vector<sf::Sprite>&);
-void updateNextPieceShow(const std::vector<sf::Sprite>& nextPiece, std::vector<sf::Sprite>& nextPiecetoShow)
+/// //////////////////////////////////////////////////////
+/// DEBUG
+void printGrid(const Bitboard& board)
 {
-    nextPiecetoShow.clear();
-    nextPiecetoShow = nextPiece;
-
-    if(nextPiecetoShow.size() == 4){
-        for(auto&& part : nextPiecetoShow){
-            part.move(360.f-(originField.x+(3*size_tile)), 250.f-originField.y);
-        }
-    } else if(nextPiecetoShow.size() == 9){
-        for(auto&& part : nextPiecetoShow){
-            part.move(350.f-(originField.x+(3*size_tile)), 250.f-originField.y);
-        }
-    } else if(nextPiecetoShow.size() == 16){
-        for(auto&& part : nextPiecetoShow){
-            part.move(340.f-(originField.x+(3*size_tile)), 240.f-originField.y);
+    for(std::size_t i=0; i<rowsGrid; ++i){
+        for(std::size_t j=0; j<colsGrid; ++j){
+            std::cout << (board.isSet(i, j) ? "1 " : "0 ");
         }
+        std::cout << '\n';
     }
+    std::cout << "----\n";
 }
 //////////////////////////////////////////////////////////
-/////// SET TEXT LINES
-void updateTextLines(sf::Text&, unsigned);
-void updateTextLines(sf::Text& text, unsigned nb_lines)
+/////// HEADLESS BATCH MODE
+// Tetris --batch [games] [threads] [seed] [random|bot]
+int batchUsage(const char *program)
 {
-    std::string tmp{std::to_string(nb_lines)};
-    text.setString(tmp);
-    text.setOrigin(text.getGlobalBounds().width / 2.f, text.getCharacterSize()/2.f);
+    std::cout << "Usage : " << program << " --batch [games] [threads (0 : all cores)] [seed] [random|bot]" << '\n';
+    return 1;
 }
-//////////////////////////////////////////////////////////
-/////// CHECK GAME OVER
-bool checkGameOver(const std::vector<sf::Sprite>&, float);
-bool checkGameOver(const std::vector<sf::Sprite>& gridSprite, float playFieldTop)
-{
-    unsigned ctr{0};
 
-    for(std::size_t i=0; i<colsGrid; ++i){
-        if(gridSprite[i].getPosition().y == playFieldTop)
-            ++ctr;
-        if(ctr>1)
-            return true;
+int runBatchMode(int argc, char *argv[])
+{
+    BatchConfig config;
+    if((argc > 2 && !Arguments::parse(argv[2], config.games)) ||
+       (argc > 3 && !Arguments::parse(argv[3], config.threads)) ||
+       (argc > 4 && !Arguments::parse(argv[4], config.seed)) ||
+       (argc > 5 && std::string(argv[5]) != "random" && std::string(argv[5]) != "bot") ||
+       argc > 6)
+        return batchUsage(argv[0]);
+    const bool useBot{argc > 5 && std::string(argv[5]) == "bot"};
+
+    if(useBot){
+        // The bot only acts once per piece : let it place before gravity
+        config.actionsPerGravity = 16;
+        config.maxPieces         = 1000;
     }
 
-    return false;
-}
-//////////////////////////////////////////////////////////
-/////// RESET GRIDS
-void resetGrids(std::vector<bool>&, std::vector<sf::Sprite>&);
-void resetGrids(std::vector<bool>& grid, std::vector<sf::Sprite>& gridSprite)
-{
-    for(auto&& b : grid)
-        b = false;
+    const BatchReport report{runBatch(config, [useBot](std::uint64_t gameSeed){
+        // Games already run in parallel : one search thread per bot, and a
+        // full two-piece search so the clock has no say in the results
+        return useBot ? Bot(1).asPolicy(2) : randomPolicy(Random::mix(gameSeed));
+    })};
+    printReport(std::cout, report);
 
-    for(unsigned i=0; i<rowsGrid; ++i){
-        for(unsigned j=0; j<colsGrid; ++j){
-            gridSprite[(i*colsGrid)+j] = sf::Sprite();
-            gridSprite.back().setPosition((j*size_tile)+originField.x, (i*size_tile)+originField.y);
-        }
-    }
+    return 0;
 }
 //////////////////////////////////////////////////////////
-/////// SAVE SCORE
-void saveScore(unsigned, const std::string&);
-void saveScore(unsigned score, const std::string& fileName)
+/////// HEADLESS REPLAY
+// Tetris --replay <file> : plays the log as fast as possible and checks the final state
+int runReplayHeadless(ReplayPlayer& player)
 {
-    std::ofstream osf(fileName, std::ios_base::app);
-    std::time_t result = std::time(nullptr);
-    osf << score << ' ' << std::asctime(std::localtime(&result));
-    osf.close();
-}
-/// //////////////////////////////////////////////////////
-/// DEBUG
-void printGrid(const std::vector<bool>& grid)
-{
-    for(std::size_t i=0; i<rowsGrid; ++i){
-        for(std::size_t j=0; j<colsGrid; ++j){
-            std::cout << ((grid[(i*colsGrid)+j] == true) ? "1 " : "0 ");
-        }
-        std::cout << '\n';
-    }
-    std::cout << "----\n";
+    sf::Clock chrono;
+    const GameState end{player.runHeadless()};
+    const float seconds{chrono.getElapsedTime().asSeconds()};
+    const bool ok{player.verify(end)};
+
+    std::cout << player.getCount() << " action(s), " << (player.getFinalTick() / TICK_RATE) << " s of play, "
+              << end.lines << " line(s), replayed in " << (seconds * 1000.f) << " ms";
+    if(seconds > 0.f)
+        std::cout << " (" << static_cast<unsigned long>(player.getCount() / seconds) << " actions/s)";
+    std::cout << '\n' << (ok ? "Final state hash OK" : "Final state hash MISMATCH") << '\n';
+
+    return ok ? 0 : 2;
 }
 //////////////////////////////////////////////////////////
 /////// MAIN
-int main()
+int main(int argc, char *argv[])
 {
+    if(argc > 1 && std::string(argv[1]) == "--batch")
+        return runBatchMode(argc, argv);
+
+    /////// Replay : headless by default, "--realtime" to watch it
+    ReplayPlayer player;
+    const bool replayMode{argc > 2 && std::string(argv[1]) == "--replay"};
+    if(replayMode){
+        if(!player.load(argv[2])){
+            std::cout << "Can't read replay " << argv[2] << '\n';
+            return 1;
+        }
+        if(!(argc > 3 && std::string(argv[3]) == "--realtime"))
+            return runReplayHeadless(player);
+    }
+
+    /////// Assets (the archive decodes while the window opens)
+    sf::Clock startup;
+    AssetLoader assets;
+    if(!assets.open("assets.pak"))
+        std::cout << "No asset archive (" << assets.getError() << "), loose files\n";
+    assets.start();
+
     sf::RenderWindow window(sf::VideoMode(SCREEN_X, SCREEN_Y), "Tetrox", sf::Style::Close);
 
+    /////// Atlas (tileset, background, game over screen in one texture)
+    TextureAtlas atlas;
+    auto addImage = [&](const std::string& name, const std::string& fileName){
+        if(auto image = assets.getImage(fileName))
+            atlas.add(name, *image);
+        else
+            std::cout << "Assets : " << assets.getError() << '\n';
+    };
+    addImage("tiles", "assets/img/tiles_set.png");
+    addImage("canva", "assets/img/canva.png");
+    addImage("gameover", "assets/img/GO_screen.png");
+    if(!atlas.build())
+        std::cout << "Atlas : " << atlas.getError() << '\n';
+
     /////// Tileset
-    sf::Texture tiles;
-    tiles.loadFromFile("assets/img/tiles_set.png");
-    std::vector<sf::Sprite> tileSet;
+    const sf::IntRect tilesRect{atlas.get("tiles")};
+    std::vector<sf::IntRect> tileSet;
     int sizeRect{static_cast<int>(size_tile)};
-    int nb_tiles{static_cast<int>(tiles.getSize().x/size_tile)};
+    int nb_tiles{tilesRect.width / sizeRect};
     for(int i=0; i<nb_tiles; ++i){
-        tileSet.push_back(sf::Sprite{tiles, sf::IntRect{i*sizeRect, 0, sizeRect, sizeRect}});
+        tileSet.push_back(sf::IntRect{tilesRect.left + (i*sizeRect), tilesRect.top, sizeRect, sizeRect});
     }
 
-    /////// Background
-    sf::Texture bg;
-    bg.loadFromFile("assets/img/canva.png");
-    sf::Sprite canva(bg);
-
-    /////// Create piece
-    std::size_t randIndex{randomID(0, 6)};
-    std::vector<sf::Sprite> piece{createPiece(patrons[randIndex], tileSet[randIndex])};
-
-    /////// Create Next Piece
-    randIndex = randomID(0, 6);
-    std::vector<sf::Sprite> nextPiece{createPiece(patrons[randIndex], tileSet[randIndex])};
-
-    /////// Copy Next Piece (just for showing)
-    std::vector<sf::Sprite> nextPiecetoShow(nextPiece.begin(), nextPiece.end());
-
-    /////// Create PlayField
-    sf::RectangleShape playField{sf::Vector2f(200.f, 400.f)};
-    playField.setPosition(originField.x, originField.y);
-    playField.setFillColor(sf::Color(230, 230, 230));
-    const float playFieldTop{playField.getGlobalBounds().top};
-    const float playFieldBottom{playField.getGlobalBounds().top + playField.getGlobalBounds().height};
-    const float playFieldLeft{playField.getGlobalBounds().left};
-    const float playFieldRight{playField.getGlobalBounds().left + playField.getGlobalBounds().width};
-    std::vector<bool> grid(200, false);
-    std::vector<sf::Sprite> gridSprites(200, sf::Sprite());
+    /////// Play layer (background + every tile)
+    SpriteBatch playLayer{&atlas.getTexture(), SLOT_COUNT};
+    playLayer.set(SLOT_CANVA, sf::FloatRect(0.f, 0.f, SCREEN_X, SCREEN_Y), atlas.get("canva"));
+
+    /////// Game (every rule lives in the engine)
+    std::uint64_t seed{replayMode ? player.getSeed() : static_cast<std::uint64_t>(std::time(nullptr))};
+    GameState game{newGame(seed)};
+
+    /////// Replay log of this game
+    ReplayRecorder recorder{seed};
+    const std::string replayFile{"datas/last.replay"};
 
     /////// Create Text View Lines
-    sf::Font digiFont;
-    digiFont.loadFromFile("assets/fonts/DS-DIGI.ttf");
-    sf::Text textLines("0", digiFont, 26);
-    // Offset height between char size and global height
-    const float offsetH{textLines.getCharacterSize() - textLines.getGlobalBounds().height};
-    // Set text's top left on window's top left
-    textLines.setPosition(0.f, -offsetH);
-    textLines.setOrigin(textLines.getGlobalBounds().width / 2.f, textLines.getCharacterSize()/2.f);
-    textLines.move(379.f, 384.f);
+    AssetLoader::FontHandle digiFont{assets.getFont("assets/fonts/DS-DIGI.TTF")};
+    if(!digiFont){
+        std::cout << "Assets : " << assets.getError() << '\n';
+        digiFont = std::make_shared<sf::Font>();
+    }
+    // Centered on x 379, digits a half line above y 384 (laid out on change only)
+    Hud hud;
+    hud.load(*digiFont, 26);
+    const float offsetH{26.f - hud.getDigitHeight()};
+    const std::size_t hudLines{hud.addCounter(sf::Vector2f(379.f, 384.f - offsetH - 13.f), Hud::CENTER, 4)};
 
     /////// Game Over Screen Components
-    sf::Texture go_texture;
-    go_texture.loadFromFile("assets/img/GO_screen.png");
-    sf::Sprite go_sprite(go_texture);
-
-    /////// CLOCK/DT
-    sf::Clock clock;
-    sf::Time dt;
+    sf::Sprite go_sprite(atlas.getTexture(), atlas.get("gameover"));
+    sf::Text textScores("", *digiFont, 24);
+    textScores.setPosition(SCREEN_X / 2.f, 120.f);
+    sf::Text textTop("", *digiFont, 20);
+    textTop.setPosition(SCREEN_X / 2.f, 340.f);
+
+    /////// Scores (binary store, the old text log is imported once)
+    ScoreStore scores{"datas/scores.bin"};
+    scores.load("datas/scores");
+
+    assets.printStats(std::cout);
+    std::cout << "Startup : " << startup.getElapsedTime().asMilliseconds() << " ms\n";
+
+    /////// LOOP (one fixed step per replay tick, 60 fps at most)
+    GameLoop loop(1.f / TICK_RATE, 60);
+    const float dt{loop.getStep()};
     float timer{0.f};   // Used for auto move down
+    std::uint32_t tick{0};
 
     /////// STATES
-    bool justLaunched{false};
     bool gameOver{false};
+    unsigned lastPieces{0};
+    LineFlash lineFlash{};
+
+    /////// AUTOPLAY (bot plays at maximum gravity, searches on its own threads)
+    Bot bot;
+    bool autoplay{false};
+    std::array<unsigned, 16> botActions{};
+    std::size_t botCount{0}, botDone{0};
+    unsigned botPieces{~0u};
+
+    /////// INPUT (fixed rate sampler, DAS/ARR)
+    // Each action goes in the step that simulates the time it was sampled
+    // at, before that step's gravity. The state is only shown once per
+    // frame though : the latency is measured up to the display, so it
+    // stays frame bound and the percentiles say so.
+    InputSampler input;
+    std::vector<InputEvent> inputs, sampled, shown;
+    inputs.reserve(64);
+    sampled.reserve(64);
+    shown.reserve(64);
+    std::size_t inputDone{0};
+
+    /////// Every action goes through here : applied, logged, shown
+    auto play = [&](unsigned act){
+        if(apply(game, act) && !replayMode)
+            recorder.record(tick, act);
+        startLineFlash(lineFlash, game.lastClear);
+    };
 
     //////////////////////////////////////////////////////////
     /////// GAME LOOP
     while (window.isOpen())
     {
-        dt = clock.restart();
-        timer += dt.asSeconds();
+        loop.beginFrame();
+        const InputClock::time_point frameTime{InputClock::now()};
 
         /////// EVENTS
         sf::Event event;
@@ -508,42 +381,21 @@ int main()
             /////// KEY PRESSED
             if(event.type == sf::Event::KeyPressed)
             {
-                // PRESSED DOWN
-                if (event.key.code == sf::Keyboard::S) {
-                    if(!collidePlayField(piece, playFieldBottom, dir::DOWN) &&
-                       !collidePiece(gridSprites, piece, dir::DOWN))
-                    {
-                        movePiece(piece, 0, 1);
-                    }
-                }
-                // PRESSED LEFT
-                if (event.key.code == sf::Keyboard::Q) {
-                    if(!collidePlayField(piece, playFieldLeft, dir::LEFT) &&
-                       !collidePiece(gridSprites, piece, dir::LEFT))
-                    {
-                        movePiece(piece, -1, 0);
-                    }
-                }
-                // PRESSED RIGHT
-                if (event.key.code == sf::Keyboard::D) {
-                    if(!collidePlayField(piece, playFieldRight, dir::RIGHT) &&
-                       !collidePiece(gridSprites, piece, dir::RIGHT))
-                    {
-                        movePiece(piece, 1, 0);
+                // Moves, rotations and drops come from the input sampler
+                if(!gameOver && !replayMode){
+                    // PRESSED AUTOPLAY
+                    if (event.key.code == sf::Keyboard::A) {
+                        autoplay  = !autoplay;
+                        botPieces = ~0u;
+                        std::cout << (autoplay ? "Autoplay ON" : "Autoplay OFF") << '\n';
                     }
                 }
-				// PRESSED ROTATE (right)
-				if (event.key.code == sf::Keyboard::R) {
-                    if(!checkSpriteIntersect(piece, gridSprites))
-                    {
-                        rotatePiece(piece);
-                    }
-				}
 
 				// GAME OVER SCREEN KEYS
-				if(gameOver){
+				if(gameOver && !replayMode){
                     if(event.key.code == sf::Keyboard::Return){
                         gameOver = false;
+                        timer    = 0.f;
                     }
 				}
 
@@ -553,9 +405,11 @@ int main()
 
                 /// DEBUG PRINT (SHORTCUT)
                 if(event.key.code == sf::Keyboard::Space){
-                    printGrid(grid);
-                    std::cout << "Total line(s) : " << line_ctr << '\n';
-                    std::cout << "Descent Delay : " << delay << '\n';
+                    printGrid(game.board);
+                    std::cout << "Total line(s) : " << game.lines << '\n';
+                    std::cout << "Descent Delay : " << game.delay << '\n';
+                    input.printLatency(std::cout);
+                    loop.printStats(std::cout);
                     std::cout << "------------------------------\n";
                 }
             }
@@ -579,73 +433,138 @@ int main()
                 window.close();
         }
 
-        /////// UPDATE
-        if(!gameOver){
+        /////// INPUT
+        input.setEnabled(!gameOver && !replayMode && !autoplay && window.hasFocus());
+        input.setGravityDelay(game.delay);
+        input.drain(sampled);
+        if(gameOver)
+            sampled.clear();
+        inputs.insert(inputs.end(), sampled.begin(), sampled.end());
+        inputDone = 0;
+
+        /////// UPDATE (gravity, replay, bot and inputs move by ticks, not by frames)
+        while(loop.step()){
+            timer += dt;
+            if(gameOver)
+                continue;
+            ++tick;
+
+            // Sampled up to the time this step simulates : frame start less
+            // the lag still to run
+            const InputClock::time_point stepTime{frameTime -
+                std::chrono::duration_cast<InputClock::duration>(std::chrono::duration<float>(loop.getAlpha() * dt))};
+            for(; inputDone < inputs.size() && inputs[inputDone].stamp <= stepTime && !game.gameOver; ++inputDone){
+                play(inputs[inputDone].act);
+                shown.push_back(inputs[inputDone]);
+            }
 
-            if(timer >= delay) {
-                if(collidePiece(gridSprites, piece, dir::DOWN) ||
-                   collidePlayField(piece, playFieldBottom, dir::DOWN))
-                {
-                    movePieceToGrid(piece, grid, gridSprites);
-                    launchNextPiece(piece, nextPiece, tileSet);
-                    justLaunched = true;
+            if(replayMode){
+                // Actions at their recorded tick ; gravity is in the log too
+                unsigned act{action::NONE};
+                while(player.next(tick, act))
+                    play(act);
+                if(player.finished() && !game.gameOver){
+                    std::cout << (player.verify(game) ? "Replay done, final state hash OK" :
+                                                         "Replay done, final state hash MISMATCH") << '\n';
+                    gameOver = true;
                 }
-
-                if(!collidePlayField(piece, playFieldBottom, dir::DOWN) && !justLaunched)
-                {
-                    movePiece(piece, 0, 1);
+            }
+            else if(autoplay){
+                // New piece : the search starts in the background for half a
+                // gravity interval at max gravity (3 ticks) ; once it is
+                // collected on a later step, one action per step
+                if(game.pieces != botPieces){
+                    bot.start(game, Bot::Budget(static_cast<long>(delayMin * 500000.f)));
+                    botCount  = 0;
+                    botDone   = 0;
+                    botPieces = game.pieces;
                 }
+                Placement placement;
+                if(botCount == 0 && bot.poll(placement))
+                    botCount = Bot::plan(placement, botActions);
+                if(botDone < botCount){
+                    play(botActions[botDone++]);
+                }
+            }
 
-                justLaunched = false;
+            if(!replayMode && timer >= (autoplay ? delayMin : game.delay)) {
+                play(action::GRAVITY);
                 timer = 0.f;
             }
 
-            if(checkGameOver(gridSprites, playFieldTop)){
-                saveScore(line_ctr, "datas/scores");
+            if(game.pieces != lastPieces){
+                updateGridQuads(game.board, tileSet, playLayer);
+                lastPieces = game.pieces;
+            }
+
+            if(game.gameOver && replayMode){
+                std::cout << (player.verify(game) ? "Replay done, final state hash OK" :
+                                                     "Replay done, final state hash MISMATCH") << '\n';
                 gameOver = true;
             }
+            else if(game.gameOver){
+                scores.add(game.lines, game.pieces);
+                updateScoreBoard(textScores, textTop, scores);
+                recorder.save(replayFile, game);
+                gameOver = true;
+
+                // Reset all
+                seed     = static_cast<std::uint64_t>(std::time(nullptr));
+                game     = newGame(seed);
+                recorder.reset(seed);
+                tick     = 0;
+                updateGridQuads(game.board, tileSet, playLayer);
+                lastPieces       = 0;
+                botPieces        = ~0u;
+                lineFlash.active = false;
+                inputDone        = inputs.size();
+            }
 
-        } else {
-            // Reset all
-            resetGrids(grid, gridSprites);
-            line_ctr        = 0;
-            delay           = delayMax;
-            randIndex       = randomID(0, 6);
-            piece           = createPiece(patrons[randIndex], tileSet[randIndex]);
-            for(auto&& part : piece) part.move(0.f, -size_tile); // Avoid offset after GO screen
-            randIndex       = randomID(0, 6);
-            nextPiece       = createPiece(patrons[randIndex], tileSet[randIndex]);
-            nextPiecetoShow = nextPiece;
+            updateLineFlash(lineFlash, dt);
         }
 
         // if(!gameOver) ? ( voir selon la prsentation de l'cran de Game Over)
         if(!gameOver){
-            eraseLines(grid, gridSprites);
-            updateTextLines(textLines, line_ctr);
-            updateNextPieceShow(nextPiece, nextPiecetoShow);
+            hud.set(hudLines, game.lines);
+            pieceQuads(maskOf(game.piece), tileSet[game.piece.id],
+                       sf::Vector2f((game.piece.x*size_tile)+originField.x, (game.piece.y*size_tile)+originField.y),
+                       playLayer, SLOT_PIECE);
+            updateNextPieceShow(game.next, tileSet, playLayer);
+            updateLineFlashQuads(lineFlash, tileSet, playLayer);
         }
 
         /////// DRAW
         window.clear();
 
         if(!gameOver){
-            window.draw(canva);
-            window.draw(textLines);
-            for(const auto& part : piece)
-                window.draw(part);
-            for(const auto& s : gridSprites)
-                window.draw(s);
-            for(const auto& part : nextPiecetoShow)
-                window.draw(part);
+            window.draw(playLayer);
+            window.draw(hud);
         }
 
         if(gameOver){
             // DRAW Screen GAME OVER
             window.draw(go_sprite);
+            window.draw(textScores);
+            window.draw(textTop);
         }
 
         window.display();
+
+        // Later samples wait for the steps of the next frame
+        for(const auto& in : shown)
+            input.noteShown(in);
+        shown.clear();
+        inputs.erase(inputs.begin(), inputs.begin() + inputDone);
+
+        loop.endFrame(window.hasFocus());
     }
 
+    input.printLatency(std::cout);
+    loop.printStats(std::cout);
+
+    // Unfinished game : keep its log too (bug reports)
+    if(!replayMode && !gameOver && recorder.getCount() > 0)
+        recorder.save(replayFile, game);
+
     return 0;
 }
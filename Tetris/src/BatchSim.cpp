@@ -0,0 +1,125 @@
+#include "../include/BatchSim.h"
+#include "../../Utilities/Random.hpp"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+
+//////////////////////////////////////////////////////////
+/////// PLAY ONE GAME
+GameState playGame(std::uint64_t seed, const BatchConfig& config, const Policy& policy)
+{
+    GameState state{newGame(seed)};
+    unsigned sinceGravity{0};
+
+    while(!state.gameOver && state.pieces < config.maxPieces){
+        const unsigned act{policy(state)};
+
+        if(act != action::NONE && act != action::GRAVITY)
+            apply(state, act);
+
+        // Gravity always comes : a policy can't stall the game
+        if(++sinceGravity >= config.actionsPerGravity || act == action::NONE || act == action::GRAVITY){
+            apply(state, action::GRAVITY);
+            sinceGravity = 0;
+        }
+    }
+
+    return state;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+/////// RUN BATCH
+BatchReport runBatch(const BatchConfig& config, const PolicyFactory& factory)
+{
+    unsigned threads{config.threads};
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1u, std::min(threads, config.games));
+
+    std::vector<unsigned> lines(config.games, 0);
+    std::vector<unsigned> pieces(config.games, 0);
+    std::atomic<unsigned> nextGame{0};
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for(unsigned w=0; w<threads; ++w){
+        workers.emplace_back([&](){
+            for(unsigned g = nextGame++; g < config.games; g = nextGame++){
+                const std::uint64_t gameSeed{Random::mix(config.seed ^ Random::mix(g))};
+                const GameState end{playGame(gameSeed, config, factory(gameSeed))};
+                lines[g]  = end.lines;
+                pieces[g] = end.pieces;
+            }
+        });
+    }
+    for(auto&& t : workers)
+        t.join();
+
+    const double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    BatchReport report{};
+    report.games       = config.games;
+    report.threads     = threads;
+    report.seconds     = seconds;
+    report.gamesPerSec = (seconds > 0) ? config.games / seconds : 0;
+
+    if(config.games == 0)
+        return report;
+
+    double sum{0}, sumSq{0};
+    for(unsigned g=0; g<config.games; ++g){
+        sum   += lines[g];
+        sumSq += static_cast<double>(lines[g]) * lines[g];
+        report.pieces += pieces[g];
+        if(pieces[g] >= config.maxPieces)
+            ++report.stopped;
+    }
+    report.meanLines   = sum / config.games;
+    report.stdDevLines = std::sqrt(std::max(0.0, (sumSq / config.games) - (report.meanLines * report.meanLines)));
+
+    std::sort(lines.begin(), lines.end());
+    report.minLines    = lines.front();
+    report.medianLines = lines[lines.size() / 2];
+    report.maxLines    = lines.back();
+
+    return report;
+}
+
+//////////////////////////////////////////////////////////
+/////// PRINT REPORT
+void printReport(std::ostream& os, const BatchReport& report)
+{
+    os << std::fixed << std::setprecision(1)
+       << report.games << " game(s) on " << report.threads << " thread(s) in "
+       << std::setprecision(3) << report.seconds << " s -> " << std::setprecision(1) << report.gamesPerSec << " games/s, "
+       << std::setprecision(0) << (report.seconds > 0 ? report.pieces / report.seconds : 0) << " pieces/s\n"
+       << std::setprecision(2)
+       << "Lines : mean " << report.meanLines << " (sd " << report.stdDevLines << ")"
+       << ", min " << report.minLines << ", median " << report.medianLines
+       << ", max " << report.maxLines << '\n';
+
+    if(report.stopped > 0)
+        os << report.stopped << " game(s) stopped at the piece limit\n";
+}
+
+//////////////////////////////////////////////////////////
+/////// RANDOM POLICY
+Policy randomPolicy(std::uint64_t seed)
+{
+    std::uint64_t state{seed};
+
+    return [state](const GameState&) mutable -> unsigned {
+        state = Random::mix(state);
+        return static_cast<unsigned>(action::MOVE_LEFT + (state % (action::HARD_DROP - action::MOVE_LEFT + 1)));
+    };
+}
@@ -0,0 +1,129 @@
+#include "../include/Bitboard.h"
+
+#include <cassert>
+#include <algorithm>
+
+const unsigned      ClearedLines::MAX_LINES;
+const unsigned      Bitboard::ROWS;
+const unsigned      Bitboard::COLS;
+const unsigned      Bitboard::WALL_LEFT;
+const std::uint16_t Bitboard::EMPTY_ROW;
+const std::uint16_t Bitboard::FULL_ROW;
+const std::uint8_t  Bitboard::NO_TILE;
+
+Bitboard::Bitboard()
+{
+    clear();
+}
+
+//////////////////////////////////////////////////////////
+/////// CLEAR
+void Bitboard::clear()
+{
+    m_rows.fill(EMPTY_ROW);
+    for(auto&& r : m_tiles)
+        r.fill(NO_TILE);
+}
+
+//////////////////////////////////////////////////////////
+/////// COLLIDE
+bool Bitboard::collide(const PieceMask& piece, int x, int y) const
+{
+    const int shift{static_cast<int>(WALL_LEFT) + x};
+    assert(shift >= 0 && "Piece box too far on the left.");
+
+    for(unsigned r=0; r<piece.boxSize; ++r){
+        const std::uint32_t bits{static_cast<std::uint32_t>(piece.rows[r]) << shift};
+        if(bits & rowAt(y + static_cast<int>(r)))
+            return true;
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////
+/////// DROP DISTANCE (rows the piece can fall before landing)
+int Bitboard::dropDistance(const PieceMask& piece, int x, int y) const
+{
+    int d{0};
+    while(!collide(piece, x, y + d + 1))
+        ++d;
+    return d;
+}
+
+//////////////////////////////////////////////////////////
+/////// PLACE
+void Bitboard::place(const PieceMask& piece, int x, int y, std::uint8_t tile)
+{
+    for(unsigned r=0; r<piece.boxSize; ++r){
+        const int i{y + static_cast<int>(r)};
+        if(piece.rows[r] == 0 || i < 0 || i >= static_cast<int>(ROWS))
+            continue;
+
+        m_rows[i] |= static_cast<std::uint16_t>(piece.rows[r] << (static_cast<int>(WALL_LEFT) + x));
+
+        for(unsigned c=0; c<piece.boxSize; ++c){
+            if((piece.rows[r] >> c) & 1u)
+                m_tiles[i][x + static_cast<int>(c)] = tile;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////
+/////// FULL LINES
+std::uint32_t Bitboard::fullLines() const
+{
+    std::uint32_t lines{0};
+
+    for(unsigned i=0; i<ROWS; ++i){
+        if(m_rows[i] == FULL_ROW)
+            lines |= (1u << i);
+    }
+
+    return lines;
+}
+
+//////////////////////////////////////////////////////////
+/////// ERASE LINES (returns the number of rows removed)
+// One bottom-up compaction pass : every kept row is moved once, straight
+// to its final place, whatever the number and spacing of the full rows.
+unsigned Bitboard::eraseLines(std::uint32_t lines, ClearedLines* cleared)
+{
+    if(cleared){
+        cleared->mask  = lines;
+        cleared->count = 0;
+    }
+    if(lines == 0)
+        return 0;
+
+    if(cleared){
+        for(unsigned i=0; i<ROWS && cleared->count<ClearedLines::MAX_LINES; ++i){
+            if((lines >> i) & 1u){
+                cleared->rows[cleared->count]  = i;
+                cleared->tiles[cleared->count] = m_tiles[i];
+                ++cleared->count;
+            }
+        }
+    }
+
+    int write{static_cast<int>(ROWS) - 1};
+
+    for(int read=static_cast<int>(ROWS) - 1; read>=0; --read){
+        if((lines >> read) & 1u)
+            continue;
+        if(write != read){
+            m_rows[write]  = m_rows[read];
+            m_tiles[write] = m_tiles[read];
+        }
+        --write;
+    }
+
+    const unsigned erased{static_cast<unsigned>(write + 1)};
+
+    for(; write>=0; --write){
+        m_rows[write] = EMPTY_ROW;
+        m_tiles[write].fill(NO_TILE);
+    }
+
+    return erased;
+}
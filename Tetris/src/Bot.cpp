@@ -0,0 +1,339 @@
+#include "../include/Bot.h"
+
+#include <limits>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+const float    LOST{-std::numeric_limits<float>::max()};
+const unsigned MAX_CANDIDATES{64};
+
+//////////////////////////////////////////////////////////
+/////// ROTATIONS (0 : none, 1 : cw, 2 : cw cw, 3 : ccw)
+bool applyRotations(GameState& state, unsigned rotations)
+{
+    switch(rotations){
+        case 1  : return apply(state, action::ROTATE_CW);
+        case 2  : return apply(state, action::ROTATE_CW) && apply(state, action::ROTATE_CW);
+        case 3  : return apply(state, action::ROTATE_CCW);
+        default : return true;
+    }
+}
+
+//////////////////////////////////////////////////////////
+/////// FOR EACH REACHABLE PLACEMENT
+// f(rotations, shift, state with the piece moved there, not dropped yet)
+template<typename F>
+void forEachPlacement(const GameState& state, F f)
+{
+    for(unsigned r=0; r<4; ++r){
+        if(state.piece.id == tetromino::O && r != 0)
+            continue;
+
+        GameState rotated{state};
+        if(!applyRotations(rotated, r))
+            continue;
+
+        f(r, 0, rotated);
+
+        for(int dir : {-1, 1}){
+            GameState moved{rotated};
+            int shift{0};
+            while(apply(moved, dir < 0 ? action::MOVE_LEFT : action::MOVE_RIGHT)){
+                shift += dir;
+                f(r, shift, moved);
+            }
+        }
+    }
+}
+
+} // namespace
+
+Bot::Bot(unsigned threads, const BotWeights& weights) :
+    m_threads{threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads},
+    m_weights(weights),
+    m_mutex(),
+    m_quit{false},
+    m_quitHelpers{false},
+    m_helpers(),
+    m_levelStart(),
+    m_levelEnd(),
+    m_level{0},
+    m_levelLeft{0},
+    m_candidates(),
+    m_nextCandidate{0},
+    m_rootLines{0},
+    m_deadline(),
+    m_searcher(),
+    m_wake(),
+    m_job(),
+    m_jobDeadline(),
+    m_jobId{0},
+    m_takenId{0},
+    m_resultId{0},
+    m_result{0, 0, LOST, false}
+{
+    m_candidates.reserve(MAX_CANDIDATES);
+    for(unsigned t=1; t<m_threads; ++t)
+        m_helpers.emplace_back(&Bot::helperLoop, this);
+}
+
+Bot::~Bot()
+{
+    // A background search still running needs the helpers to end
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    if(m_searcher.joinable())
+        m_searcher.join();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quitHelpers = true;
+    }
+    m_levelStart.notify_all();
+    for(auto&& t : m_helpers)
+        t.join();
+}
+
+//////////////////////////////////////////////////////////
+/////// EVALUATE
+// One pass from the top : 'covered' collects every column already
+// topped by a block, so a hole is an empty cell under a covered column.
+float Bot::evaluate(const Bitboard& board, unsigned linesCleared) const
+{
+    const std::uint16_t field{static_cast<std::uint16_t>(~Bitboard::EMPTY_ROW)};
+    std::array<int, Bitboard::COLS> heights{};
+    std::uint16_t covered{0};
+    int holes{0};
+
+    for(unsigned i=0; i<Bitboard::ROWS; ++i){
+        const std::uint16_t cells{static_cast<std::uint16_t>(board.row(i) & field)};
+        const std::uint16_t fresh{static_cast<std::uint16_t>(cells & ~covered)};
+
+        if(fresh){
+            for(unsigned j=0; j<Bitboard::COLS; ++j)
+                if((fresh >> (Bitboard::WALL_LEFT + j)) & 1u)
+                    heights[j] = static_cast<int>(Bitboard::ROWS - i);
+        }
+
+        std::uint16_t empty{static_cast<std::uint16_t>(~cells & covered & field)};
+        for(; empty; empty &= static_cast<std::uint16_t>(empty - 1))
+            ++holes;
+
+        covered |= cells;
+    }
+
+    int height{0}, bumpiness{0};
+    for(unsigned j=0; j<Bitboard::COLS; ++j){
+        height += heights[j];
+        if(j > 0)
+            bumpiness += std::abs(heights[j] - heights[j-1]);
+    }
+
+    return (m_weights.height * height) + (m_weights.lines * linesCleared) +
+           (m_weights.holes * holes) + (m_weights.bumpiness * bumpiness);
+}
+
+//////////////////////////////////////////////////////////
+/////// CHOOSE
+Placement Bot::choose(const GameState& state, Budget budget)
+{
+    return search(state, 2, Clock::now() + budget);
+}
+
+Placement Bot::choose(const GameState& state, unsigned depth)
+{
+    return search(state, depth, Clock::time_point::max());
+}
+
+Placement Bot::search(const GameState& state, unsigned depth, Clock::time_point deadline)
+{
+    /////// Level 1 : current piece, scored alone (fallback if time runs out)
+    std::vector<Candidate>& candidates = m_candidates;
+    candidates.clear();
+
+    forEachPlacement(state, [&](unsigned r, int shift, const GameState& moved){
+        if(candidates.size() >= MAX_CANDIDATES)
+            return;
+        Candidate c{Placement{r, shift, 0.f, true}, moved, 0, 0.f, false};
+        apply(c.dropped, action::HARD_DROP);
+        c.lines = c.dropped.lines - state.lines;
+        c.score = c.dropped.gameOver ? LOST : evaluate(c.dropped.board, c.lines);
+        c.placement.score = c.score;
+        candidates.push_back(c);
+    });
+
+    if(candidates.empty())
+        return Placement{0, 0, LOST, false};
+    if(depth < 2)
+        return std::max_element(candidates.begin(), candidates.end(),
+                                [](const Candidate& a, const Candidate& b){ return a.placement.score < b.placement.score; })->placement;
+
+    /////// Level 2 : next piece on each resulting board, shared with the helpers
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nextCandidate = 0;
+        m_rootLines     = state.lines;
+        m_deadline      = deadline;
+        m_levelLeft     = static_cast<unsigned>(m_helpers.size());
+        ++m_level;
+    }
+    m_levelStart.notify_all();
+    secondLevel();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_levelEnd.wait(lock, [this]{ return m_levelLeft == 0; });
+    }
+
+    // Level-1 and level-2 scores don't compare : when the deadline cut level 2
+    // short, only the candidates it finished are ranked (a lost first drop
+    // stays out, it can't beat them). None finished : level 1 for all.
+    auto deepBest = candidates.end();
+    for(auto it = candidates.begin(); it != candidates.end(); ++it)
+        if(it->deep && (deepBest == candidates.end() || deepBest->score < it->score))
+            deepBest = it;
+
+    if(deepBest != candidates.end()){
+        Placement p{deepBest->placement};
+        p.score = deepBest->score;
+        return p;
+    }
+    return std::max_element(candidates.begin(), candidates.end(),
+                            [](const Candidate& a, const Candidate& b){ return a.placement.score < b.placement.score; })->placement;
+}
+
+// Candidates are taken one at a time until none is left or time is up
+void Bot::secondLevel()
+{
+    for(std::size_t k = m_nextCandidate++; k < m_candidates.size(); k = m_nextCandidate++){
+        if(Clock::now() >= m_deadline)
+            return;
+
+        Candidate& c = m_candidates[k];
+        if(c.dropped.gameOver)
+            continue;
+
+        float best{LOST};
+        forEachPlacement(c.dropped, [&](unsigned, int, const GameState& moved){
+            GameState second{moved};
+            apply(second, action::HARD_DROP);
+            if(second.gameOver)
+                return;
+            best = std::max(best, evaluate(second.board, second.lines - m_rootLines));
+        });
+        c.score = best;
+        c.deep  = true;
+    }
+}
+
+void Bot::helperLoop()
+{
+    std::uint64_t seen{0};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(;;){
+        m_levelStart.wait(lock, [&]{ return m_quitHelpers || m_level != seen; });
+        if(m_quitHelpers)
+            return;
+        seen = m_level;
+
+        lock.unlock();
+        secondLevel();
+        lock.lock();
+
+        if(--m_levelLeft == 0)
+            m_levelEnd.notify_one();
+    }
+}
+
+//////////////////////////////////////////////////////////
+/////// BACKGROUND SEARCH
+void Bot::start(const GameState& state, Budget budget)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job         = state;
+        m_jobDeadline = Clock::now() + budget;
+        ++m_jobId;
+    }
+    if(!m_searcher.joinable())
+        m_searcher = std::thread(&Bot::searchLoop, this);
+    m_wake.notify_one();
+}
+
+bool Bot::poll(Placement& placement)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_jobId == 0 || m_resultId != m_jobId)
+        return false;
+    placement  = m_result;
+    m_resultId = 0;     // given once
+    return true;
+}
+
+// Always on the newest search asked : one started while another ran
+// replaces any still waiting
+void Bot::searchLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(;;){
+        m_wake.wait(lock, [this]{ return m_quit || m_takenId != m_jobId; });
+        if(m_quit)
+            return;
+        m_takenId = m_jobId;
+        const GameState state{m_job};
+        const Clock::time_point deadline{m_jobDeadline};
+
+        lock.unlock();
+        const Placement placement{search(state, 2, deadline)};
+        lock.lock();
+
+        m_result   = placement;
+        m_resultId = m_takenId;
+    }
+}
+
+//////////////////////////////////////////////////////////
+/////// PLAN
+std::size_t Bot::plan(const Placement& placement, std::array<unsigned, 16>& actions)
+{
+    std::size_t n{0};
+
+    switch(placement.rotations){
+        case 1 : actions[n++] = action::ROTATE_CW; break;
+        case 2 : actions[n++] = action::ROTATE_CW; actions[n++] = action::ROTATE_CW; break;
+        case 3 : actions[n++] = action::ROTATE_CCW; break;
+        default : break;
+    }
+
+    const unsigned move{placement.shift < 0 ? action::MOVE_LEFT : action::MOVE_RIGHT};
+    for(int s=0; s<std::abs(placement.shift) && n+1<actions.size(); ++s)
+        actions[n++] = move;
+
+    actions[n++] = action::HARD_DROP;
+    return n;
+}
+
+//////////////////////////////////////////////////////////
+/////// AS POLICY (for the batch simulator)
+Policy Bot::asPolicy(unsigned depth) const
+{
+    // Shared by the copies of the policy (std::function copies it)
+    const std::shared_ptr<Bot> bot{std::make_shared<Bot>(m_threads, m_weights)};
+    std::array<unsigned, 16> actions{};
+    std::size_t count{0}, done{0};
+    unsigned pieces{~0u};
+
+    return [=](const GameState& state) mutable -> unsigned {
+        if(state.pieces != pieces || done >= count){
+            pieces = state.pieces;
+            count  = plan(bot->choose(state, depth), actions);
+            done   = 0;
+        }
+        return actions[done++];
+    };
+}
@@ -0,0 +1,191 @@
+#include "../include/Engine.h"
+#include "../../Utilities/Random.hpp"
+
+#include <cassert>
+
+namespace {
+
+//////////////////////////////////////////////////////////
+/////// RANDOMIZER (splitmix64 : 8 bytes of state, copied with the game)
+std::size_t randomID(std::uint64_t& state)
+{
+    return static_cast<std::size_t>(Random::splitmix64(state) % tetromino::TETROMINO_MAX);
+}
+
+//////////////////////////////////////////////////////////
+/////// CREATE PIECE
+Piece createPiece(std::size_t id)
+{
+    assert(id < tetromino::TETROMINO_MAX && "Unknown piece.");
+    return Piece{id, 0, spawnCol, 0};
+}
+
+//////////////////////////////////////////////////////////
+/////// MOVE PIECE (returns false if blocked)
+bool movePiece(const Bitboard& board, Piece& piece, int dx, int dy)
+{
+    if(board.collide(maskOf(piece), piece.x + dx, piece.y + dy))
+        return false;
+
+    piece.x += dx;
+    piece.y += dy;
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+/////// ROTATE PIECE (SRS : tries each wall kick in order)
+bool rotatePiece(const Bitboard& board, Piece& piece, bool clockwise)
+{
+    const unsigned rot{clockwise ? (piece.rot + 1) % 4 : (piece.rot + 3) % 4};
+    const CellOffset *kicks{kicksFor(piece.id, clockwise ? piece.rot : rot)};
+    const int sign{clockwise ? 1 : -1};
+
+    for(std::size_t k=0; k<KICK_TESTS; ++k){
+        const int x{piece.x + (sign * kicks[k].x)};
+        const int y{piece.y + (sign * kicks[k].y)};
+        if(!board.collide(maskOf(piece.id, rot), x, y)){
+            piece.rot = rot;
+            piece.x   = x;
+            piece.y   = y;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////
+/////// ERASE LINES (speeds gravity up every 5 lines)
+void eraseLines(GameState& state)
+{
+    const unsigned erased{state.board.eraseLines(state.board.fullLines(), &state.lastClear)};
+
+    for(unsigned l=0; l<erased; ++l){
+
+        ++state.lines;
+
+        if(state.lines%5 == 0){
+
+            if(state.delay>0.5f)
+                state.delay -= 0.075f;
+            else
+                state.delay -=0.05f;
+
+            if(state.delay<delayMin)
+                state.delay = delayMin;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////
+/////// CHECK GAME OVER (stack reached the top, or no room for the new piece)
+bool checkGameOver(const GameState& state)
+{
+    return state.board.row(0) != Bitboard::EMPTY_ROW ||
+           state.board.collide(maskOf(state.piece), state.piece.x, state.piece.y);
+}
+
+//////////////////////////////////////////////////////////
+/////// LOCK PIECE, CLEAR, LAUNCH NEXT
+void lockPiece(GameState& state)
+{
+    state.board.place(maskOf(state.piece), state.piece.x, state.piece.y,
+                      static_cast<std::uint8_t>(state.piece.id));
+    ++state.pieces;
+    eraseLines(state);
+
+    state.piece = state.next;
+    state.next  = createPiece(randomID(state.rng));
+
+    state.gameOver = checkGameOver(state);
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+/////// NEW GAME
+GameState newGame(std::uint64_t seed)
+{
+    GameState state;
+    state.rng             = seed;
+    state.piece           = createPiece(randomID(state.rng));
+    state.next            = createPiece(randomID(state.rng));
+    state.lines           = 0;
+    state.pieces          = 0;
+    state.delay           = delayMax;
+    state.gameOver        = false;
+    state.lastClear.mask  = 0;
+    state.lastClear.count = 0;
+
+    return state;
+}
+
+//////////////////////////////////////////////////////////
+/////// STEP
+GameState step(const GameState& state, unsigned act)
+{
+    GameState next{state};
+    apply(next, act);
+    return next;
+}
+
+//////////////////////////////////////////////////////////
+/////// APPLY
+bool apply(GameState& state, unsigned act)
+{
+    state.lastClear.mask  = 0;
+    state.lastClear.count = 0;
+
+    if(state.gameOver)
+        return false;
+
+    switch(act){
+        case action::MOVE_LEFT  : return movePiece(state.board, state.piece, -1, 0);
+        case action::MOVE_RIGHT : return movePiece(state.board, state.piece, 1, 0);
+        case action::SOFT_DROP  : return movePiece(state.board, state.piece, 0, 1);
+        case action::ROTATE_CW  : return rotatePiece(state.board, state.piece, true);
+        case action::ROTATE_CCW : return rotatePiece(state.board, state.piece, false);
+        case action::HARD_DROP  :
+            state.piece.y += state.board.dropDistance(maskOf(state.piece), state.piece.x, state.piece.y);
+            lockPiece(state);
+            return true;
+        case action::GRAVITY    :
+            if(!movePiece(state.board, state.piece, 0, 1))
+                lockPiece(state);
+            return true;
+        default :
+            return false;
+    }
+}
+
+//////////////////////////////////////////////////////////
+/////// STATE HASH
+std::uint64_t stateHash(const GameState& state)
+{
+    std::uint64_t h{0xCBF29CE484222325ull};
+    auto mix = [&h](std::uint64_t value, unsigned bytes){
+        for(unsigned i=0; i<bytes; ++i){
+            h ^= (value >> (8*i)) & 0xFF;
+            h *= 0x100000001B3ull;
+        }
+    };
+
+    for(unsigned i=0; i<Bitboard::ROWS; ++i){
+        mix(state.board.row(i), 2);
+        for(unsigned j=0; j<Bitboard::COLS; ++j)
+            mix(state.board.tile(i, j), 1);
+    }
+    for(const Piece* p : {&state.piece, &state.next}){
+        mix(p->id, 1);
+        mix(p->rot, 1);
+        mix(static_cast<std::uint32_t>(p->x), 4);
+        mix(static_cast<std::uint32_t>(p->y), 4);
+    }
+    mix(state.rng, 8);
+    mix(state.lines, 4);
+    mix(state.pieces, 4);
+    mix(static_cast<std::uint64_t>(state.delay * 1000000.f), 8);
+    mix(state.gameOver ? 1 : 0, 1);
+
+    return h;
+}
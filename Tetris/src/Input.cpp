@@ -0,0 +1,184 @@
+#include "../include/Input.h"
+
+#include <algorithm>
+#include <iomanip>
+
+const std::size_t InputSampler::LATENCY_RING;
+
+namespace {
+
+InputClock::duration seconds(float s)
+{
+    return std::chrono::duration_cast<InputClock::duration>(std::chrono::duration<float>(s));
+}
+
+} // namespace
+
+InputSampler::InputSampler(const InputConfig& config) :
+    m_config(config),
+    m_enabled{false},
+    m_gravityDelay{delayMax},
+    m_quit{false},
+    m_mutex(),
+    m_queue(),
+    m_left{false, {}},
+    m_right{false, {}},
+    m_softDrop{false, {}},
+    m_rotateCW{false},
+    m_rotateCCW{false},
+    m_hardDrop{false},
+    m_lastShift{action::NONE},
+    m_latencies(LATENCY_RING, 0.f),
+    m_latencyCount{0}
+{
+    m_queue.reserve(64);
+    m_thread = std::thread(&InputSampler::run, this);
+}
+
+InputSampler::~InputSampler()
+{
+    m_quit = true;
+    m_thread.join();
+}
+
+////////// SAMPLER THREAD
+void InputSampler::run()
+{
+    const InputClock::duration period{std::chrono::microseconds(1000000 / std::max(1u, m_config.sampleRate))};
+    std::vector<InputEvent> sampled;
+    InputClock::time_point next{InputClock::now()};
+
+    while(!m_quit){
+        const InputClock::time_point now{InputClock::now()};
+
+        if(m_enabled){
+            sample(now, sampled);
+            if(!sampled.empty()){
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.insert(m_queue.end(), sampled.begin(), sampled.end());
+                sampled.clear();
+            }
+        }
+        else{
+            release();
+        }
+
+        // Fixed rate : late samples don't pile up
+        next += period;
+        if(next < now)
+            next = now + period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void InputSampler::release()
+{
+    m_left.down = m_right.down = m_softDrop.down = false;
+    m_rotateCW = m_rotateCCW = m_hardDrop = false;
+    m_lastShift = action::NONE;
+}
+
+void InputSampler::sample(InputClock::time_point now, std::vector<InputEvent>& out)
+{
+    const InputClock::duration das{seconds(m_config.das)};
+    const InputClock::duration arr{seconds(m_config.arr)};
+
+    /////// LEFT / RIGHT : first move on press, DAS, then ARR
+    auto shift = [&](HeldKey& key, sf::Keyboard::Key code, unsigned act){
+        const bool down{sf::Keyboard::isKeyPressed(code)};
+        if(down && !key.down){
+            out.push_back({act, now});
+            key.next    = now + das;
+            m_lastShift = act;
+        }
+        else if(!down && key.down && m_lastShift == act){
+            m_lastShift = action::NONE;
+        }
+        key.down = down;
+
+        // Both held : only the last one pressed repeats
+        if(!down || m_lastShift != act || now < key.next)
+            return;
+        if(arr == InputClock::duration::zero()){
+            // ARR 0 : straight to the wall
+            for(unsigned i=0; i<Bitboard::COLS; ++i)
+                out.push_back({act, now});
+            key.next = now + das;
+            return;
+        }
+        while(key.next <= now){
+            out.push_back({act, now});
+            key.next += arr;
+        }
+    };
+    shift(m_left, m_config.left, action::MOVE_LEFT);
+    shift(m_right, m_config.right, action::MOVE_RIGHT);
+    if(m_lastShift == action::NONE){
+        // Released the last one but the other is still held : it takes over after DAS
+        if(m_left.down)       { m_lastShift = action::MOVE_LEFT;  m_left.next  = now + das; }
+        else if(m_right.down) { m_lastShift = action::MOVE_RIGHT; m_right.next = now + das; }
+    }
+
+    /////// SOFT DROP : repeats at gravity / factor from the press
+    const bool drop{sf::Keyboard::isKeyPressed(m_config.softDrop)};
+    const InputClock::duration dropRate{seconds(m_gravityDelay / std::max(1.f, m_config.softDropFactor))};
+    if(drop && !m_softDrop.down){
+        out.push_back({action::SOFT_DROP, now});
+        m_softDrop.next = now + dropRate;
+    }
+    else if(drop){
+        while(m_softDrop.next <= now){
+            out.push_back({action::SOFT_DROP, now});
+            m_softDrop.next += dropRate;
+        }
+    }
+    m_softDrop.down = drop;
+
+    /////// ROTATIONS / HARD DROP : once per press
+    auto edge = [&](bool& held, sf::Keyboard::Key code, unsigned act){
+        const bool down{sf::Keyboard::isKeyPressed(code)};
+        if(down && !held)
+            out.push_back({act, now});
+        held = down;
+    };
+    edge(m_rotateCW, m_config.rotateCW, action::ROTATE_CW);
+    edge(m_rotateCCW, m_config.rotateCCW, action::ROTATE_CCW);
+    edge(m_hardDrop, m_config.hardDrop, action::HARD_DROP);
+}
+
+////////// GAME LOOP SIDE
+void InputSampler::drain(std::vector<InputEvent>& out)
+{
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out.swap(m_queue);
+}
+
+void InputSampler::noteShown(const InputEvent& event)
+{
+    const std::chrono::duration<float, std::micro> latency{InputClock::now() - event.stamp};
+    m_latencies[m_latencyCount++ % LATENCY_RING] = latency.count();
+}
+
+void InputSampler::printLatency(std::ostream& os) const
+{
+    if(m_latencyCount == 0){
+        os << "Input to display latency : no input\n";
+        return;
+    }
+
+    const std::size_t kept{m_latencyCount < LATENCY_RING ? m_latencyCount : LATENCY_RING};
+    std::vector<float> sorted(m_latencies.begin(), m_latencies.begin() + kept);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](float p){
+        return sorted[static_cast<std::size_t>(p * (sorted.size() - 1))] / 1000.f;
+    };
+
+    os << "Input to display latency (" << m_latencyCount << " actions";
+    if(kept < m_latencyCount)
+        os << ", last " << kept;
+    os << ", sampled at "
+       << m_config.sampleRate << " Hz) : " << std::fixed << std::setprecision(2)
+       << "p50 " << percentile(0.5f) << " ms, p90 " << percentile(0.9f)
+       << " ms, p99 " << percentile(0.99f) << " ms, max " << sorted.back() / 1000.f << " ms\n";
+}
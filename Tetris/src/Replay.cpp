@@ -0,0 +1,174 @@
+#include "../include/Replay.h"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+namespace {
+
+const char          MAGIC[4]{'T', 'R', 'P', 'L'};
+const std::uint8_t  VERSION{1};
+const unsigned      ACTION_BITS{3};
+
+template<typename T>
+void writeLE(std::ofstream& os, T value)
+{
+    for(std::size_t i=0; i<sizeof(T); ++i)
+        os.put(static_cast<char>((value >> (8*i)) & 0xFF));
+}
+
+template<typename T>
+bool readLE(std::ifstream& is, T& value)
+{
+    value = 0;
+    for(std::size_t i=0; i<sizeof(T); ++i){
+        const int c{is.get()};
+        if(c == std::char_traits<char>::eof())
+            return false;
+        value |= static_cast<T>(static_cast<T>(c & 0xFF) << (8*i));
+    }
+    return true;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+/////// RECORDER
+ReplayRecorder::ReplayRecorder(std::uint64_t seed)
+{
+    reset(seed);
+}
+
+void ReplayRecorder::reset(std::uint64_t seed)
+{
+    m_seed     = seed;
+    m_count    = 0;
+    m_lastTick = 0;
+    m_events.clear();
+    m_events.reserve(1 << 16);
+}
+
+void ReplayRecorder::record(std::uint32_t tick, unsigned act)
+{
+    static_assert(action::ACTION_MAX <= (1u << ACTION_BITS), "Actions don't fit the event encoding.");
+
+    if(tick < m_lastTick)
+        tick = m_lastTick;
+
+    std::uint64_t value{(static_cast<std::uint64_t>(tick - m_lastTick) << ACTION_BITS) | act};
+    do{
+        const std::uint8_t byte{static_cast<std::uint8_t>(value & 0x7F)};
+        value >>= 7;
+        m_events.push_back(value ? (byte | 0x80) : byte);
+    } while(value);
+
+    m_lastTick = tick;
+    ++m_count;
+}
+
+bool ReplayRecorder::save(const std::string& fileName, const GameState& finalState) const
+{
+    std::ofstream os(fileName, std::ios_base::binary | std::ios_base::trunc);
+    if(!os)
+        return false;
+
+    os.write(MAGIC, sizeof(MAGIC));
+    os.put(static_cast<char>(VERSION));
+    writeLE(os, m_seed);
+    writeLE(os, m_count);
+    writeLE(os, m_lastTick);
+    writeLE(os, stateHash(finalState));
+    os.write(reinterpret_cast<const char*>(m_events.data()), static_cast<std::streamsize>(m_events.size()));
+
+    return static_cast<bool>(os);
+}
+
+//////////////////////////////////////////////////////////
+/////// PLAYER
+ReplayPlayer::ReplayPlayer() :
+    m_seed{0},
+    m_count{0},
+    m_finalTick{0},
+    m_finalHash{0},
+    m_events()
+{
+    rewind();
+}
+
+bool ReplayPlayer::load(const std::string& fileName)
+{
+    std::ifstream is(fileName, std::ios_base::binary);
+    if(!is)
+        return false;
+
+    char magic[4]{};
+    is.read(magic, sizeof(magic));
+    if(!is || !std::equal(magic, magic + 4, MAGIC) || is.get() != VERSION)
+        return false;
+
+    if(!readLE(is, m_seed) || !readLE(is, m_count) ||
+       !readLE(is, m_finalTick) || !readLE(is, m_finalHash))
+        return false;
+
+    m_events.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    rewind();
+
+    return true;
+}
+
+void ReplayPlayer::rewind()
+{
+    m_offset     = 0;
+    m_played     = 0;
+    m_tick       = 0;
+    m_pending    = false;
+    m_pendingAct = action::NONE;
+}
+
+bool ReplayPlayer::decode(std::uint32_t& tick, unsigned& act)
+{
+    std::uint64_t value{0};
+    unsigned shift{0};
+
+    while(m_offset < m_events.size() && shift < 64){
+        const std::uint8_t byte{m_events[m_offset++]};
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+        if(!(byte & 0x80)){
+            m_tick += static_cast<std::uint32_t>(value >> ACTION_BITS);
+            tick    = m_tick;
+            act     = static_cast<unsigned>(value & ((1u << ACTION_BITS) - 1));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ReplayPlayer::next(std::uint32_t tick, unsigned& act)
+{
+    if(!m_pending){
+        if(finished() || !decode(m_tick, m_pendingAct))
+            return false;
+        m_pending = true;
+    }
+
+    if(m_tick > tick)
+        return false;
+
+    act       = m_pendingAct;
+    m_pending = false;
+    ++m_played;
+    return true;
+}
+
+GameState ReplayPlayer::runHeadless()
+{
+    GameState state{newGame(m_seed)};
+    unsigned act{action::NONE};
+
+    while(next(~0u, act))
+        apply(state, act);
+
+    return state;
+}
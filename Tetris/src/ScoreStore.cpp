@@ -0,0 +1,268 @@
+#include "../include/ScoreStore.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+const std::size_t ScoreStore::TOP_MAX;
+const std::size_t ScoreStore::ROLLING;
+
+namespace {
+
+const char          MAGIC[4]{'T', 'S', 'C', 'O'};
+const std::uint8_t  VERSION{1};
+const std::size_t   HEADER_SIZE{4 + 1 + 4};
+const std::size_t   ENTRY_SIZE{4 + 4 + 8};
+
+template<typename T>
+void writeLE(std::ofstream& os, T value)
+{
+    for(std::size_t i=0; i<sizeof(T); ++i)
+        os.put(static_cast<char>((static_cast<std::uint64_t>(value) >> (8*i)) & 0xFF));
+}
+
+template<typename T>
+bool readLE(std::ifstream& is, T& value)
+{
+    std::uint64_t tmp{0};
+    for(std::size_t i=0; i<sizeof(T); ++i){
+        const int c{is.get()};
+        if(c == std::char_traits<char>::eof())
+            return false;
+        tmp |= static_cast<std::uint64_t>(c & 0xFF) << (8*i);
+    }
+    value = static_cast<T>(tmp);
+    return true;
+}
+
+// Puts 'from' in place of 'to' in one step. rename() does that on POSIX ;
+// Windows refuses to rename over an existing file, MoveFileEx doesn't.
+bool replaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// Higher lines first, then the oldest game keeps its rank
+bool better(const ScoreEntry& a, const ScoreEntry& b)
+{
+    return a.lines != b.lines ? a.lines > b.lines : a.time < b.time;
+}
+
+} // namespace
+
+ScoreStore::ScoreStore(const std::string& fileName) :
+    m_fileName{fileName},
+    m_entries(),
+    m_top(),
+    m_rollingSum{0},
+    m_writer(),
+    m_mutex(),
+    m_wake(),
+    m_pending(),
+    m_dirty{false},
+    m_quit{false}
+{
+    m_top.reserve(TOP_MAX + 1);
+    m_writer = std::thread(&ScoreStore::writerLoop, this);
+}
+
+ScoreStore::~ScoreStore()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    // Last pending write is flushed before the thread ends
+    m_writer.join();
+}
+
+////////// LOAD
+bool ScoreStore::load(const std::string& legacyFile)
+{
+    std::ifstream is(m_fileName, std::ios_base::binary);
+    if(!is)
+        return importLegacy(legacyFile);
+
+    is.seekg(0, std::ios_base::end);
+    const std::streamoff fileSize{is.tellg()};
+    is.seekg(0, std::ios_base::beg);
+
+    char magic[4]{};
+    std::uint32_t count{0};
+    is.read(magic, sizeof(magic));
+    if(!is || !std::equal(magic, magic + 4, MAGIC) || is.get() != VERSION || !readLE(is, count) ||
+       count > static_cast<std::uint64_t>(fileSize - HEADER_SIZE) / ENTRY_SIZE){
+        is.close();
+        return setAside();
+    }
+
+    std::vector<ScoreEntry> loaded;
+    loaded.reserve(count);
+    for(std::uint32_t i=0; i<count; ++i){
+        ScoreEntry entry{};
+        if(!readLE(is, entry.lines) || !readLE(is, entry.pieces) || !readLE(is, entry.time)){
+            is.close();
+            return setAside();
+        }
+        loaded.push_back(entry);
+    }
+
+    for(const auto& entry : loaded){
+        m_entries.push_back(entry);
+        index(entry);
+    }
+
+    // The writer keeps its own copy : hand it what is already on disk
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.insert(m_pending.end(), loaded.begin(), loaded.end());
+
+    return true;
+}
+
+// A file that doesn't read back is kept as "<file>.bad" : the next save
+// would otherwise write the new games alone over the old history
+bool ScoreStore::setAside()
+{
+    replaceFile(m_fileName, m_fileName + ".bad");
+    return false;
+}
+
+bool ScoreStore::importLegacy(const std::string& legacyFile)
+{
+    if(legacyFile.empty())
+        return false;
+
+    std::ifstream is(legacyFile);
+    if(!is)
+        return false;
+
+    std::string line;
+    while(std::getline(is, line)){
+        std::istringstream iss(line);
+        ScoreEntry entry{};
+        std::tm date{};
+        if(!(iss >> entry.lines))
+            continue;
+        iss >> std::get_time(&date, "%a %b %d %H:%M:%S %Y");
+        if(!iss.fail()){
+            date.tm_isdst = -1;
+            entry.time = static_cast<std::int64_t>(std::mktime(&date));
+        }
+        m_entries.push_back(entry);
+        index(entry);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.insert(m_pending.end(), m_entries.begin(), m_entries.end());
+        m_dirty = true;
+    }
+    m_wake.notify_one();
+
+    return true;
+}
+
+////////// ADD
+void ScoreStore::add(unsigned lines, unsigned pieces)
+{
+    const ScoreEntry entry{lines, pieces, static_cast<std::int64_t>(std::time(nullptr))};
+
+    m_entries.push_back(entry);
+    index(entry);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(entry);
+        m_dirty = true;
+    }
+    m_wake.notify_one();
+}
+
+void ScoreStore::index(const ScoreEntry& entry)
+{
+    // Top-N : insertion in a small sorted vector
+    const auto it = std::upper_bound(m_top.begin(), m_top.end(), entry, better);
+    if(static_cast<std::size_t>(it - m_top.begin()) < TOP_MAX){
+        m_top.insert(it, entry);
+        if(m_top.size() > TOP_MAX)
+            m_top.pop_back();
+    }
+
+    // Rolling sum over the last ROLLING entries (entry is already in m_entries)
+    m_rollingSum += entry.lines;
+    if(m_entries.size() > ROLLING)
+        m_rollingSum -= m_entries[m_entries.size() - ROLLING - 1].lines;
+}
+
+////////// QUERIES
+float ScoreStore::rollingAverage() const
+{
+    const std::size_t n{std::min(m_entries.size(), ROLLING)};
+    return n ? static_cast<float>(m_rollingSum) / n : 0.f;
+}
+
+////////// WRITER THREAD
+void ScoreStore::writerLoop()
+{
+    std::vector<ScoreEntry> all;
+    std::vector<ScoreEntry> incoming;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(;;){
+        m_wake.wait(lock, [this]{ return m_dirty || m_quit || !m_pending.empty(); });
+
+        const bool write{m_dirty};
+        incoming.swap(m_pending);
+        m_dirty = false;
+        const bool quit{m_quit};
+
+        lock.unlock();
+        all.insert(all.end(), incoming.begin(), incoming.end());
+        incoming.clear();
+        if(write)
+            writeFile(m_fileName, all);
+        lock.lock();
+
+        if(quit && !m_dirty)
+            return;
+    }
+}
+
+bool ScoreStore::writeFile(const std::string& fileName, const std::vector<ScoreEntry>& entries)
+{
+    const std::string tmpName{fileName + ".tmp"};
+    {
+        std::ofstream os(tmpName, std::ios_base::binary | std::ios_base::trunc);
+        if(!os)
+            return false;
+
+        os.write(MAGIC, sizeof(MAGIC));
+        os.put(static_cast<char>(VERSION));
+        writeLE(os, static_cast<std::uint32_t>(entries.size()));
+        for(const auto& entry : entries){
+            writeLE(os, entry.lines);
+            writeLE(os, entry.pieces);
+            writeLE(os, entry.time);
+        }
+        os.flush();
+        if(!os)
+            return false;
+    }
+
+    return replaceFile(tmpName, fileName);
+}
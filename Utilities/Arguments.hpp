@@ -0,0 +1,53 @@
+#ifndef ARGUMENTS_HPP
+#define ARGUMENTS_HPP
+
+#include <string>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <cstddef>
+
+//////////////////////////////////////////////////////////
+/////// ARGUMENTS
+// Command line values of the extra game modes. A bad value is reported, so
+// the caller can print its usage : nothing throws out of main, and "-1"
+// doesn't wrap to a huge count.
+namespace Arguments{
+
+    // Whole string, digits only, fits a T (an unsigned type)
+    template<typename T>
+    bool parse(const char *text, T& value)
+    {
+        if(text[0] < '0' || text[0] > '9')
+            return false;
+        try{
+            std::size_t used{0};
+            const unsigned long long parsed{std::stoull(text, &used)};
+            if(text[used] != '\0' || parsed > std::numeric_limits<T>::max())
+                return false;
+            value = static_cast<T>(parsed);
+            return true;
+        }
+        catch(const std::logic_error&){
+            return false;
+        }
+    }
+
+    // Whole string, finite, not negative
+    inline bool parse(const char *text, float& value)
+    {
+        try{
+            std::size_t used{0};
+            const float parsed{std::stof(text, &used)};
+            if(text[used] != '\0' || !std::isfinite(parsed) || parsed < 0.f)
+                return false;
+            value = parsed;
+            return true;
+        }
+        catch(const std::logic_error&){
+            return false;
+        }
+    }
+}
+
+#endif // ARGUMENTS_HPP
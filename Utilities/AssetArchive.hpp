@@ -0,0 +1,216 @@
+#ifndef ASSETARCHIVE_HPP
+#define ASSETARCHIVE_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+#include "MappedFile.hpp"
+
+//////////////////////////////////////////////////////////
+/////// ASSET ARCHIVE
+// Every asset file of a game in one mapped file, looked up by the path it
+// had when packed ("assets/img/ball.png"). Knows nothing of SFML : the
+// loader decodes, the packer tool writes.
+// File (little-endian) :
+//   "ASPK", version u8, reserved u8, entry count u16
+//   index : name length u8 + name, kind u8, offset u32 + size u32 (from
+//           file start), for each entry
+//   data  : files as they were on disk, each one 16-byte aligned
+class AssetArchive
+{
+public:
+    enum kind : std::uint8_t{
+        RAW,
+        IMAGE,
+        SOUND,
+        FONT,
+        KIND_MAX
+    };
+
+    struct Entry
+    {
+        std::string   name;
+        kind          type;
+        std::uint32_t offset;
+        std::uint32_t size;
+    };
+
+    static const std::size_t NONE = static_cast<std::size_t>(-1);
+
+    AssetArchive() : m_file(), m_entries(), m_error() {}
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    // Reads the index only : data pages are touched when decoded
+    bool open(const std::string& fileName)
+    {
+        m_entries.clear();
+        m_error.clear();
+
+        if(!m_file.open(fileName)){
+            m_error = "can't open " + fileName;
+            return false;
+        }
+
+        const std::uint8_t *data = m_file.data();
+        const std::size_t size{m_file.size()};
+        if(size < HEADER_SIZE || !std::equal(magic(), magic() + 4, reinterpret_cast<const char*>(data)) || data[4] != VERSION){
+            m_error = fileName + " is not an asset archive (or not this version)";
+            m_file.close();
+            return false;
+        }
+
+        const std::size_t count{static_cast<std::size_t>(data[6] | (data[7] << 8))};
+        std::size_t pos{HEADER_SIZE};
+        for(std::size_t i=0; i<count; ++i){
+            if(pos >= size || pos + 1 + data[pos] + 9 > size){
+                m_error = "truncated index in " + fileName;
+                m_entries.clear();
+                m_file.close();
+                return false;
+            }
+            Entry entry;
+            entry.name.assign(reinterpret_cast<const char*>(data + pos + 1), data[pos]);
+            pos += 1 + data[pos];
+            entry.type   = static_cast<kind>(std::min<std::uint8_t>(data[pos], KIND_MAX - 1));
+            entry.offset = readU32(data + pos + 1);
+            entry.size   = readU32(data + pos + 5);
+            pos += 9;
+            if(static_cast<std::size_t>(entry.offset) + entry.size > size){
+                m_error = entry.name + " is out of " + fileName;
+                m_entries.clear();
+                m_file.close();
+                return false;
+            }
+            m_entries.push_back(entry);
+        }
+        return true;
+    }
+
+    std::size_t find(const std::string& name) const
+    {
+        for(std::size_t i=0; i<m_entries.size(); ++i)
+            if(m_entries[i].name == name)
+                return i;
+        return NONE;
+    }
+
+    inline bool isOpen() const { return m_file.isOpen(); }
+    inline bool isMapped() const { return m_file.isMapped(); }
+    inline std::size_t count() const { return m_entries.size(); }
+    inline std::size_t fileSize() const { return m_file.size(); }
+    inline const Entry& getEntry(std::size_t i) const { return m_entries[i]; }
+    // Valid while the archive is open
+    inline const std::uint8_t* getData(std::size_t i) const { return m_file.data() + m_entries[i].offset; }
+    inline const std::string& getError() const { return m_error; }
+
+    ////////// TOOL SIDE
+    // From the file extension
+    static kind kindOf(const std::string& fileName)
+    {
+        const std::size_t dot{fileName.find_last_of('.')};
+        std::string ext{dot == std::string::npos ? "" : fileName.substr(dot + 1)};
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char c){
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        });
+
+        if(ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp" || ext == "tga" || ext == "gif" || ext == "psd")
+            return IMAGE;
+        if(ext == "wav" || ext == "ogg" || ext == "flac")
+            return SOUND;
+        if(ext == "ttf" || ext == "otf")
+            return FONT;
+        return RAW;
+    }
+
+    // Files are stored under the names given, read from the working directory
+    static bool write(const std::string& fileName, const std::vector<std::string>& files, std::string& error)
+    {
+        if(files.size() > 0xFFFF){
+            error = "too many files";
+            return false;
+        }
+
+        std::vector<std::string> blobs;
+        for(const auto& f : files){
+            if(f.empty() || f.size() > 255){
+                error = "bad file name '" + f + "'";
+                return false;
+            }
+            std::ifstream is(f, std::ios_base::binary);
+            if(!is){
+                error = "can't read " + f;
+                return false;
+            }
+            blobs.emplace_back(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        }
+
+        std::string out(magic(), magic() + 4);
+        out.push_back(static_cast<char>(VERSION));
+        out.push_back(0);
+        out.push_back(static_cast<char>(files.size() & 0xFF));
+        out.push_back(static_cast<char>(files.size() >> 8));
+
+        // Index first, the data offsets follow its size
+        std::size_t indexSize{0};
+        for(const auto& f : files)
+            indexSize += 1 + f.size() + 9;
+        std::size_t offset{align(HEADER_SIZE + indexSize)};
+        for(std::size_t i=0; i<files.size(); ++i){
+            if(offset + blobs[i].size() > 0xFFFFFFFFu){
+                error = "archive over 4 GB";
+                return false;
+            }
+            out.push_back(static_cast<char>(files[i].size()));
+            out += files[i];
+            out.push_back(static_cast<char>(kindOf(files[i])));
+            putU32(out, static_cast<std::uint32_t>(offset));
+            putU32(out, static_cast<std::uint32_t>(blobs[i].size()));
+            offset = align(offset + blobs[i].size());
+        }
+        for(const auto& blob : blobs){
+            out.resize(align(out.size()), '\0');
+            out += blob;
+        }
+
+        std::ofstream os(fileName, std::ios_base::binary | std::ios_base::trunc);
+        os.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if(!os){
+            error = "can't write " + fileName;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const std::uint8_t    VERSION = 1;
+    static const std::size_t     HEADER_SIZE = 8;
+    static const std::size_t     ALIGN = 16;
+
+    MappedFile          m_file;
+    std::vector<Entry>  m_entries;
+    std::string         m_error;
+
+    static const char* magic() { return "ASPK"; }
+    static std::size_t align(std::size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+    static std::uint32_t readU32(const std::uint8_t *p)
+    {
+        return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+               (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+    }
+
+    static void putU32(std::string& out, std::uint32_t v)
+    {
+        for(int i=0; i<4; ++i)
+            out.push_back(static_cast<char>((v >> (8*i)) & 0xFF));
+    }
+};
+
+#endif // ASSETARCHIVE_HPP
@@ -0,0 +1,359 @@
+#ifndef ASSETLOADER_HPP
+#define ASSETLOADER_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include <SFML/Graphics.hpp>
+#include <SFML/System.hpp>
+#ifndef ASSETLOADER_NO_AUDIO
+    #include <SFML/Audio.hpp>
+#else
+    namespace sf { class SoundBuffer; }
+#endif
+
+#include "AssetArchive.hpp"
+
+//////////////////////////////////////////////////////////
+/////// ASSET LOADER
+// Images, sounds and fonts of a game, asked for by file name and handed
+// out as shared handles (null if the asset can't be loaded : see
+// getError()).
+// With an archive open, start() decodes every image and sound of it on a
+// pool of loader threads while the game sets up ; get*() only waits for
+// the one asked. Fonts are read lazily by SFML, straight from the mapped
+// archive. Without an archive, assets are loaded from their files on
+// first use, as before.
+// The loader must outlive the fonts it gave : they read its mapping.
+// Games that don't link sfml-audio define ASSETLOADER_NO_AUDIO before
+// including this : sounds are then left undecoded.
+class AssetLoader
+{
+public:
+    typedef std::shared_ptr<const sf::Image>       ImageHandle;
+    typedef std::shared_ptr<const sf::SoundBuffer> SoundHandle;
+    typedef std::shared_ptr<const sf::Font>        FontHandle;
+
+    struct Stats
+    {
+        bool          packed{false};
+        bool          mapped{false};
+        std::size_t   archiveBytes{0};
+        std::size_t   images{0}, sounds{0}, fonts{0};
+        std::size_t   failed{0};           // assets that didn't load
+        unsigned      threads{0};
+        float         openMs{0.f};
+        float         decodeMs{0.f};       // start() to the last decode done
+        float         busyMs{0.f};         // decode time summed over the threads
+    };
+
+    AssetLoader() :
+        m_archive(),
+        m_slots(),
+        m_loose(),
+        m_workers(),
+        m_next{0},
+        m_left{0},
+        m_busyUs{0},
+        m_decodeUs{0},
+        m_started{false},
+        m_clock(),
+        m_stats(),
+        m_error()
+    {
+
+    }
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    ~AssetLoader() { wait(); }
+
+    // False : no archive, assets will come from loose files
+    bool open(const std::string& fileName)
+    {
+        wait();
+        m_slots.clear();
+        m_started = false;
+        m_stats   = Stats();
+
+        sf::Clock clock;
+        if(!m_archive.open(fileName)){
+            m_error = m_archive.getError();
+            return false;
+        }
+        m_slots = std::vector<Slot>(m_archive.count());
+        for(auto&& slot : m_slots)
+            slot.ready = slot.done.get_future().share();
+
+        m_stats.packed       = true;
+        m_stats.mapped       = m_archive.isMapped();
+        m_stats.archiveBytes = m_archive.fileSize();
+        m_stats.openMs       = clock.getElapsedTime().asMicroseconds() / 1000.f;
+        return true;
+    }
+
+    // Decodes every image and sound of the archive in the background
+    // (0 : one thread per core)
+    void start(unsigned threads = 0)
+    {
+        if(!m_archive.isOpen() || m_started)
+            return;
+        m_started = true;
+
+        std::size_t jobs{0};
+        for(std::size_t i=0; i<m_slots.size(); ++i){
+            if(m_slots[i].decoded || !isDecoded(i)){
+                m_slots[i].done.set_value();
+                continue;
+            }
+            ++jobs;
+        }
+        if(jobs == 0)
+            return;
+
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, jobs));
+
+        m_next   = 0;
+        m_left   = threads;
+        m_busyUs = 0;
+        m_stats.threads = threads;
+        m_clock.restart();
+        for(unsigned t=0; t<threads; ++t)
+            m_workers.emplace_back(&AssetLoader::work, this);
+    }
+
+    // Until every background decode is done
+    void wait()
+    {
+        for(auto&& w : m_workers)
+            w.join();
+        m_workers.clear();
+    }
+
+    ////////// ASSETS
+    ImageHandle getImage(const std::string& name)
+    {
+        const std::size_t i{packed(name, AssetArchive::IMAGE)};
+        if(i == AssetArchive::NONE){
+            Loose& loose = m_loose[name];
+            if(!loose.image){
+                auto image = std::make_shared<sf::Image>();
+                if(!image->loadFromFile(name))
+                    return fail("can't load " + name);
+                loose.image = image;
+                ++m_stats.images;
+            }
+            return loose.image;
+        }
+        ready(i);
+        if(!m_slots[i].image){
+            m_error = m_slots[i].error;
+            return nullptr;
+        }
+        return m_slots[i].image;
+    }
+
+    SoundHandle getSound(const std::string& name)
+    {
+#ifdef ASSETLOADER_NO_AUDIO
+        return fail("no audio in this build, can't load " + name);
+#else
+        const std::size_t i{packed(name, AssetArchive::SOUND)};
+        if(i == AssetArchive::NONE){
+            Loose& loose = m_loose[name];
+            if(!loose.sound){
+                auto sound = std::make_shared<sf::SoundBuffer>();
+                if(!sound->loadFromFile(name))
+                    return fail("can't load " + name);
+                loose.sound = sound;
+                ++m_stats.sounds;
+            }
+            return loose.sound;
+        }
+        ready(i);
+        if(!m_slots[i].sound){
+            m_error = m_slots[i].error;
+            return nullptr;
+        }
+        return m_slots[i].sound;
+#endif
+    }
+
+    FontHandle getFont(const std::string& name)
+    {
+        const std::size_t i{packed(name, AssetArchive::FONT)};
+        Loose& loose = m_loose[name];
+        if(!loose.font){
+            auto font = std::make_shared<sf::Font>();
+            const bool loaded{i == AssetArchive::NONE ? font->loadFromFile(name) :
+                                                         font->loadFromMemory(m_archive.getData(i), m_archive.getEntry(i).size)};
+            if(!loaded)
+                return fail("can't load " + name);
+            loose.font = font;
+            ++m_stats.fonts;
+        }
+        return loose.font;
+    }
+
+    ////////// STATS
+    // Background decodes count once done
+    Stats getStats() const
+    {
+        Stats stats(m_stats);
+        for(const auto& slot : m_slots){
+            const bool done{m_started ? slot.ready.wait_for(std::chrono::seconds(0)) == std::future_status::ready :
+                                        slot.decoded};
+            if(!done)
+                continue;
+            if(slot.image)
+                ++stats.images;
+            if(slot.sound)
+                ++stats.sounds;
+            if(!slot.error.empty())
+                ++stats.failed;
+        }
+        stats.decodeMs = m_decodeUs / 1000.f;
+        stats.busyMs   = m_busyUs / 1000.f;
+        return stats;
+    }
+
+    void printStats(std::ostream& os) const
+    {
+        const Stats s = getStats();
+        os << std::fixed << std::setprecision(2) << "Assets : ";
+        if(s.packed)
+            os << (s.archiveBytes / 1024.f) << " KB archive (" << (s.mapped ? "mapped" : "read") << ", index "
+               << s.openMs << " ms), ";
+        else
+            os << "loose files, ";
+        os << s.images << " image(s), " << s.sounds << " sound(s), " << s.fonts << " font(s)";
+        if(s.threads > 0)
+            os << ", decoded in " << s.decodeMs << " ms on " << s.threads << " thread(s) (" << s.busyMs << " ms of work)";
+        if(s.failed > 0)
+            os << ", " << s.failed << " failed";
+        os << '\n';
+    }
+
+    inline const std::string& getError() const { return m_error; }
+
+private:
+    struct Slot
+    {
+        std::promise<void>           done;
+        std::shared_future<void>     ready;
+        bool                         decoded{false};
+        std::shared_ptr<sf::Image>   image;
+        std::shared_ptr<sf::SoundBuffer> sound;
+        std::string                  error;
+    };
+
+    // Loose files, and fonts (never decoded ahead)
+    struct Loose
+    {
+        ImageHandle image;
+        SoundHandle sound;
+        FontHandle  font;
+    };
+
+    AssetArchive                m_archive;
+    std::vector<Slot>           m_slots;
+    std::map<std::string, Loose> m_loose;
+    std::vector<std::thread>    m_workers;
+    std::atomic<std::size_t>    m_next;
+    std::atomic<unsigned>       m_left;         // loader threads still working
+    std::atomic<long long>      m_busyUs;
+    std::atomic<long long>      m_decodeUs;
+    bool                        m_started;
+    sf::Clock                   m_clock;
+    Stats                       m_stats;
+    std::string                 m_error;
+
+    std::nullptr_t fail(const std::string& error)
+    {
+        m_error = error;
+        ++m_stats.failed;
+        return nullptr;
+    }
+
+    // Index in the archive if packed as that kind, NONE otherwise
+    std::size_t packed(const std::string& name, AssetArchive::kind type) const
+    {
+        const std::size_t i{m_archive.isOpen() ? m_archive.find(name) : AssetArchive::NONE};
+        if(i == AssetArchive::NONE || m_archive.getEntry(i).type != type)
+            return AssetArchive::NONE;
+        return i;
+    }
+
+    inline bool isDecoded(std::size_t i) const
+    {
+#ifdef ASSETLOADER_NO_AUDIO
+        return m_archive.getEntry(i).type == AssetArchive::IMAGE;
+#else
+        return m_archive.getEntry(i).type == AssetArchive::IMAGE || m_archive.getEntry(i).type == AssetArchive::SOUND;
+#endif
+    }
+
+    // Decoded in the background, or here and now if start() wasn't called
+    void ready(std::size_t i)
+    {
+        if(m_started){
+            m_slots[i].ready.wait();
+            return;
+        }
+        if(!m_slots[i].decoded){
+            decode(i);
+            m_slots[i].decoded = true;
+        }
+    }
+
+    void decode(std::size_t i)
+    {
+        const AssetArchive::Entry& entry = m_archive.getEntry(i);
+        Slot& slot = m_slots[i];
+        if(entry.type == AssetArchive::IMAGE){
+            auto image = std::make_shared<sf::Image>();
+            if(image->loadFromMemory(m_archive.getData(i), entry.size))
+                slot.image = image;
+        }
+#ifndef ASSETLOADER_NO_AUDIO
+        else if(entry.type == AssetArchive::SOUND){
+            auto sound = std::make_shared<sf::SoundBuffer>();
+            if(sound->loadFromMemory(m_archive.getData(i), entry.size))
+                slot.sound = sound;
+        }
+#endif
+        if(!slot.image && !slot.sound)
+            slot.error = "can't decode " + entry.name;
+    }
+
+    // Loader thread : takes the next slot to decode until none is left.
+    // Counts are only touched by the game thread, after wait().
+    void work()
+    {
+        sf::Clock busy;
+        for(std::size_t i=m_next++; i<m_slots.size(); i=m_next++){
+            if(!isDecoded(i) || m_slots[i].decoded)
+                continue;
+            busy.restart();
+            decode(i);
+            m_busyUs += busy.getElapsedTime().asMicroseconds();
+            m_slots[i].done.set_value();
+        }
+        if(--m_left == 0)
+            m_decodeUs = m_clock.getElapsedTime().asMicroseconds();
+    }
+};
+
+#endif // ASSETLOADER_HPP
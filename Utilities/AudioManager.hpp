@@ -0,0 +1,242 @@
+#ifndef AUDIOMANAGER_HPP
+#define AUDIOMANAGER_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <cstdint>
+
+#include <SFML/Audio.hpp>
+#include <SFML/System.hpp>
+
+//////////////////////////////////////////////////////////
+/////// SPSC QUEUE
+// Fixed ring for one producer thread and one consumer thread. No lock :
+// each side only writes its own index. push() fails when full instead
+// of waiting. N must be a power of two.
+template<typename T, std::size_t N>
+class SpscQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    SpscQueue() : m_head{0}, m_tail{0}, m_items() {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer
+    bool push(const T& item)
+    {
+        const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+        if(tail - m_head.load(std::memory_order_acquire) == N)
+            return false;
+        m_items[tail & (N - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer
+    bool pop(T& item)
+    {
+        const std::size_t head{m_head.load(std::memory_order_relaxed)};
+        if(head == m_tail.load(std::memory_order_acquire))
+            return false;
+        item = m_items[head & (N - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Indexes on their own cache lines : producer and consumer don't share one
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+    alignas(64) std::array<T, N>         m_items;
+};
+
+//////////////////////////////////////////////////////////
+/////// AUDIO MANAGER
+// Every sound is decoded once, at load time, into a buffer shared by all
+// its plays. Plays go through a fixed pool of voices : a free voice if
+// there is one, else the oldest voice of lowest priority is stolen (never
+// one of higher priority than the request). So fast repeats overlap instead
+// of restarting one sf::Sound.
+// The game thread only pushes commands into a lock-free queue ; an audio
+// thread owns the voices and runs them. play() never blocks the frame.
+class AudioManager
+{
+public:
+    static const std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+    explicit AudioManager(std::size_t voices = 16) :
+        m_buffers(),
+        m_voices(voices),
+        m_commands(),
+        m_thread(),
+        m_running{false},
+        m_dropped{0},
+        m_stolen{0},
+        m_error()
+    {
+
+    }
+
+    AudioManager(const AudioManager&) = delete;
+    AudioManager& operator=(const AudioManager&) = delete;
+
+    ~AudioManager() { stop(); }
+
+    // Before start() : returns the sound id, NONE if the file can't be decoded
+    std::size_t load(const std::string& fileName)
+    {
+        auto buffer = std::make_shared<sf::SoundBuffer>();
+        if(!buffer->loadFromFile(fileName)){
+            m_error = "can't load " + fileName;
+            return NONE;
+        }
+        return add(buffer);
+    }
+
+    // Before start() : an already decoded sound (shared, not copied), NONE if null
+    std::size_t add(std::shared_ptr<const sf::SoundBuffer> buffer)
+    {
+        if(!buffer || m_running){
+            m_error = buffer ? "can't add a sound while playing" : "no sound to add";
+            return NONE;
+        }
+        m_buffers.push_back(buffer);
+        return m_buffers.size() - 1;
+    }
+
+    void start()
+    {
+        if(m_running)
+            return;
+        m_running = true;
+        m_thread  = std::thread(&AudioManager::run, this);
+    }
+
+    void stop()
+    {
+        if(!m_running)
+            return;
+        m_running = false;
+        m_thread.join();
+        for(auto&& v : m_voices)
+            v.sound.stop();
+    }
+
+    ////////// GAME THREAD (one producer)
+    // Higher priority plays may cut lower ones. False if the queue is full.
+    bool play(std::size_t sound, int priority = 0, float volume = 100.f, float pitch = 1.f)
+    {
+        if(sound >= m_buffers.size())
+            return false;
+        return push(Command{Command::PLAY, sound, priority, volume, pitch});
+    }
+
+    bool stopAll() { return push(Command{Command::STOP_ALL, NONE, 0, 0.f, 0.f}); }
+
+    ////////// STATS
+    // Commands lost to a full queue, or plays no voice could take
+    inline std::size_t dropped() const { return m_dropped; }
+    // Plays that cut a lower priority voice
+    inline std::size_t stolen() const { return m_stolen; }
+    inline std::size_t voiceCount() const { return m_voices.size(); }
+    inline const std::string& getError() const { return m_error; }
+
+private:
+    struct Command
+    {
+        enum type{PLAY, STOP_ALL};
+        type        kind;
+        std::size_t sound;
+        int         priority;
+        float       volume;
+        float       pitch;
+    };
+
+    struct Voice
+    {
+        sf::Sound     sound;
+        int           priority{0};
+        std::uint64_t started{0};     // order of the play, oldest is stolen first
+    };
+
+    // Time the audio thread sleeps when there is nothing to do
+    static const int IDLE_MS = 2;
+
+    std::vector<std::shared_ptr<const sf::SoundBuffer>> m_buffers;
+    std::vector<Voice>            m_voices;      // audio thread only
+    SpscQueue<Command, 256>       m_commands;
+    std::thread                   m_thread;
+    std::atomic<bool>             m_running;
+    std::atomic<std::size_t>      m_dropped;
+    std::atomic<std::size_t>      m_stolen;
+    std::string                   m_error;
+
+    bool push(const Command& command)
+    {
+        if(!m_running || !m_commands.push(command)){
+            ++m_dropped;
+            return false;
+        }
+        return true;
+    }
+
+    ////////// AUDIO THREAD
+    void run()
+    {
+        std::uint64_t plays{0};
+        Command command;
+        while(m_running){
+            bool worked{false};
+            while(m_commands.pop(command)){
+                worked = true;
+                if(command.kind == Command::STOP_ALL){
+                    for(auto&& v : m_voices)
+                        v.sound.stop();
+                    continue;
+                }
+
+                Voice *voice = pickVoice(command.priority);
+                if(voice == nullptr){
+                    ++m_dropped;
+                    continue;
+                }
+                voice->sound.stop();
+                voice->sound.setBuffer(*m_buffers[command.sound]);
+                voice->sound.setVolume(command.volume);
+                voice->sound.setPitch(command.pitch);
+                voice->sound.play();
+                voice->priority = command.priority;
+                voice->started  = ++plays;
+            }
+            if(!worked)
+                sf::sleep(sf::milliseconds(IDLE_MS));
+        }
+    }
+
+    // A free voice, else the oldest of the lowest priority not above 'priority'
+    Voice* pickVoice(int priority)
+    {
+        Voice *victim = nullptr;
+        for(auto&& v : m_voices){
+            if(v.sound.getStatus() == sf::Sound::Stopped)
+                return &v;
+            if(v.priority <= priority &&
+               (victim == nullptr || v.priority < victim->priority ||
+                (v.priority == victim->priority && v.started < victim->started)))
+                victim = &v;
+        }
+        if(victim != nullptr)
+            ++m_stolen;
+        return victim;
+    }
+};
+
+#endif // AUDIOMANAGER_HPP
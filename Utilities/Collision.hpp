@@ -0,0 +1,165 @@
+#ifndef COLLISION_HPP
+#define COLLISION_HPP
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <SFML/Graphics.hpp>
+
+//////////////////////////////////////////////////////////
+/////// CONTINUOUS COLLISION (circle vs axis aligned boxes)
+// A moving circle against a box is a ray against the box grown by the
+// radius with rounded corners : slabs for the sides, ray vs circle for
+// the corners. Times are fractions of the move, normals point out of the box.
+namespace Collision{
+
+	struct Hit
+	{
+		bool         hit{false};
+		float        time{1.f};      // [0, 1] of the move
+		sf::Vector2f normal{0.f, 0.f};
+	};
+
+	// Earliest obstacle of a query, 'id' is up to the caller
+	struct Contact
+	{
+		Hit         hit;
+		std::size_t id{0};
+	};
+
+	inline float dot(const sf::Vector2f& a, const sf::Vector2f& b)
+	{
+		return (a.x * b.x) + (a.y * b.y);
+	}
+
+	inline sf::Vector2f reflect(const sf::Vector2f& v, const sf::Vector2f& n)
+	{
+		return v - (2.f * dot(v, n)) * n;
+	}
+
+	/////////// RAY VS CIRCLE (smallest root in [0, 1])
+	inline bool rayCircle(const sf::Vector2f& p, const sf::Vector2f& d,
+	                      const sf::Vector2f& c, float r, float& t)
+	{
+		const sf::Vector2f m{p - c};
+		const float a{dot(d, d)};
+		const float b{dot(m, d)};
+		const float k{dot(m, m) - r*r};
+		const float disc{b*b - a*k};
+		if(a <= 0.f || disc < 0.f)
+			return false;
+		t = (-b - std::sqrt(disc)) / a;
+		return t >= 0.f && t <= 1.f;
+	}
+
+	/////////// SWEEP CIRCLE VS BOX
+	inline Hit sweepCircleRect(const sf::Vector2f& center, float radius,
+	                           const sf::Vector2f& delta, const sf::FloatRect& box)
+	{
+		Hit result;
+		const float left{box.left}, right{box.left + box.width};
+		const float top{box.top},   bottom{box.top + box.height};
+
+		// Already touching : only a hit if still moving into the box
+		const sf::Vector2f closest{std::min(std::max(center.x, left), right),
+		                           std::min(std::max(center.y, top), bottom)};
+		const sf::Vector2f away{center - closest};
+		const float dist2{dot(away, away)};
+		if(dist2 <= radius*radius){
+			sf::Vector2f n;
+			if(dist2 > 0.f){
+				n = away / std::sqrt(dist2);
+			}
+			else{
+				// Center inside the box : push out along the shallowest side
+				const float dl{center.x - left}, dr{right - center.x};
+				const float dt{center.y - top},  db{bottom - center.y};
+				const float m{std::min(std::min(dl, dr), std::min(dt, db))};
+				n = (m == dl) ? sf::Vector2f{-1.f, 0.f} : (m == dr) ? sf::Vector2f{1.f, 0.f} :
+				    (m == dt) ? sf::Vector2f{0.f, -1.f} : sf::Vector2f{0.f, 1.f};
+			}
+			if(dot(delta, n) < 0.f){
+				result.hit    = true;
+				result.time   = 0.f;
+				result.normal = n;
+			}
+			return result;
+		}
+
+		// Slabs of the grown box
+		float tEnter{0.f}, tExit{1.f};
+		sf::Vector2f normal{0.f, 0.f};
+		auto slab = [&](float p, float d, float lo, float hi, const sf::Vector2f& nLo, const sf::Vector2f& nHi){
+			if(d == 0.f)
+				return p >= lo && p <= hi;
+			float t0{(lo - p) / d}, t1{(hi - p) / d};
+			sf::Vector2f n{nLo};
+			if(t0 > t1){
+				std::swap(t0, t1);
+				n = nHi;
+			}
+			if(t0 > tEnter){
+				tEnter = t0;
+				normal = n;
+			}
+			tExit = std::min(tExit, t1);
+			return tEnter <= tExit;
+		};
+		if(!slab(center.x, delta.x, left - radius, right + radius, {-1.f, 0.f}, {1.f, 0.f}) ||
+		   !slab(center.y, delta.y, top - radius, bottom + radius, {0.f, -1.f}, {0.f, 1.f}))
+			return result;
+
+		// Entry point in a corner square : the real shape there is a quarter circle
+		const sf::Vector2f entry{center + tEnter * delta};
+		const bool outX{entry.x < left || entry.x > right};
+		const bool outY{entry.y < top || entry.y > bottom};
+		if(outX && outY){
+			const sf::Vector2f corner{entry.x < left ? left : right, entry.y < top ? top : bottom};
+			float t{0.f};
+			if(!rayCircle(center, delta, corner, radius, t))
+				return result;
+			tEnter = t;
+			normal = ((center + t * delta) - corner) / radius;
+		}
+
+		result.hit    = true;
+		result.time   = tEnter;
+		result.normal = normal;
+		return result;
+	}
+
+	/////////// MOVE WITH SEVERAL IMPACTS
+	// findHit(center, delta) -> Contact : earliest obstacle on that move
+	// onHit(contact, velocity) : response, may change the velocity
+	// Returns the number of impacts resolved.
+	template<typename FindHit, typename OnHit>
+	unsigned moveCircle(sf::Vector2f& center, sf::Vector2f& velocity, float dt,
+	                    FindHit findHit, OnHit onHit, unsigned maxImpacts = 8)
+	{
+		const float skin{1e-3f};    // stays that far from the surface after an impact
+		unsigned impacts{0};
+
+		while(dt > 0.f){
+			const sf::Vector2f delta{velocity * dt};
+			const Contact contact{findHit(center, delta)};
+
+			if(!contact.hit.hit){
+				center += delta;
+				break;
+			}
+
+			center += delta * contact.hit.time + contact.hit.normal * skin;
+			dt     *= 1.f - contact.hit.time;
+			onHit(contact, velocity);
+
+			// Stuck between obstacles : stop at the contact rather than tunnel
+			if(++impacts >= maxImpacts)
+				break;
+		}
+
+		return impacts;
+	}
+}
+
+#endif // COLLISION_HPP
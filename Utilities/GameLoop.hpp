@@ -0,0 +1,173 @@
+#ifndef GAMELOOP_HPP
+#define GAMELOOP_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+
+#include <SFML/System.hpp>
+
+//////////////////////////////////////////////////////////
+/////// GAME LOOP
+// Fixed simulation steps, free rendering, paced frames :
+//
+//     while(window.isOpen()){
+//         loop.beginFrame();
+//         ... events ...
+//         while(loop.step())
+//             ... update by loop.getStep() ...
+//         ... draw, 'loop.getAlpha()' of the way from the previous step ...
+//         loop.endFrame(window.hasFocus());
+//     }
+//
+// Updates always see the same dt, whatever the frame rate, so the rules
+// don't depend on the machine. A frame that comes too late runs at most
+// maxSteps steps, and the rest is dropped, so a slow frame can't make the
+// next one slower. endFrame() sleeps away what is left of the frame
+// budget instead of spinning. Without focus the loop runs at the lower
+// unfocused cap.
+class GameLoop
+{
+public:
+    // Means over the last second
+    struct Stats
+    {
+        float         fps{0.f};
+        float         stepsPerSec{0.f};
+        float         frameMs{0.f};        // begin to begin
+        float         worstFrameMs{0.f};
+        float         workMs{0.f};         // begin to endFrame(), sleep excluded
+        float         sleepMs{0.f};
+        unsigned long droppedSteps{0};     // since the start
+    };
+
+    explicit GameLoop(float step = 1.f / 60.f, unsigned frameCap = 60, unsigned unfocusedCap = 20,
+                      unsigned maxSteps = 8) :
+        m_step{sf::seconds(step)},
+        m_frameCap{frameCap},
+        m_unfocusedCap{unfocusedCap},
+        m_maxSteps{std::max(1u, maxSteps)},
+        m_clock(),
+        m_frameStart(),
+        m_lag(),
+        m_started{false},
+        m_stats(),
+        m_span()
+    {
+
+    }
+
+    // 0 : no cap (vertical sync, if any, paces the frames)
+    inline void setFrameCap(unsigned fps) { m_frameCap = fps; }
+    inline void setUnfocusedCap(unsigned fps) { m_unfocusedCap = fps; }
+    inline float getStep() const { return m_step.asSeconds(); }
+
+    ////////// FRAME
+    void beginFrame()
+    {
+        const sf::Time now{m_clock.getElapsedTime()};
+        const sf::Time frame{m_started ? now - m_frameStart : sf::Time::Zero};
+        m_frameStart = now;
+        m_started    = true;
+
+        m_lag += frame;
+        const sf::Time most{m_step * static_cast<sf::Int64>(m_maxSteps)};
+        if(m_lag > most){
+            m_stats.droppedSteps += static_cast<unsigned long>((m_lag - most).asMicroseconds() / m_step.asMicroseconds());
+            m_lag = most;
+        }
+
+        m_span.frameUs += frame.asMicroseconds();
+        m_span.worstUs  = std::max(m_span.worstUs, frame.asMicroseconds());
+    }
+
+    // True while a step is due : update once per true
+    bool step()
+    {
+        if(m_lag < m_step)
+            return false;
+        m_lag -= m_step;
+        ++m_span.steps;
+        return true;
+    }
+
+    // Share of a step elapsed since the last update, in [0, 1) : draw
+    // moving things that far from their previous position
+    inline float getAlpha() const { return m_lag / m_step; }
+
+    void endFrame(bool focused = true)
+    {
+        const sf::Time work{m_clock.getElapsedTime() - m_frameStart};
+        m_span.workUs += work.asMicroseconds();
+
+        const unsigned cap{focused ? m_frameCap : m_unfocusedCap};
+        if(cap > 0)
+            pace(m_frameStart + sf::seconds(1.f / cap));
+
+        ++m_span.frames;
+        const sf::Time span{m_clock.getElapsedTime() - m_span.start};
+        if(span >= sf::seconds(1.f))
+            publish(span);
+    }
+
+    ////////// STATS
+    inline const Stats& getStats() const { return m_stats; }
+
+    void printStats(std::ostream& os) const
+    {
+        os << std::fixed << std::setprecision(1)
+           << m_stats.fps << " fps, " << m_stats.stepsPerSec << " steps/s, frame "
+           << std::setprecision(2) << m_stats.frameMs << " ms (worst " << m_stats.worstFrameMs << "), work "
+           << m_stats.workMs << " ms, sleep " << m_stats.sleepMs << " ms, "
+           << m_stats.droppedSteps << " step(s) dropped\n";
+    }
+
+private:
+    // Under this, sleeping may overshoot the deadline : yield instead
+    static const sf::Int64 SPIN_US = 1000;
+
+    struct Span
+    {
+        sf::Time      start;
+        unsigned long frames{0}, steps{0};
+        sf::Int64     frameUs{0}, worstUs{0}, workUs{0}, sleepUs{0};
+    };
+
+    sf::Time  m_step;
+    unsigned  m_frameCap, m_unfocusedCap;
+    unsigned  m_maxSteps;
+    sf::Clock m_clock;
+    sf::Time  m_frameStart;
+    sf::Time  m_lag;
+    bool      m_started;
+    Stats     m_stats;
+    Span      m_span;
+
+    void pace(const sf::Time& deadline)
+    {
+        const sf::Time before{m_clock.getElapsedTime()};
+        const sf::Time left{deadline - before};
+        if(left.asMicroseconds() > SPIN_US)
+            sf::sleep(left - sf::microseconds(SPIN_US));
+        while(m_clock.getElapsedTime() < deadline)
+            std::this_thread::yield();
+        m_span.sleepUs += (m_clock.getElapsedTime() - before).asMicroseconds();
+    }
+
+    void publish(const sf::Time& span)
+    {
+        const float frames{static_cast<float>(std::max(1ul, m_span.frames))};
+        m_stats.fps          = m_span.frames / span.asSeconds();
+        m_stats.stepsPerSec  = m_span.steps / span.asSeconds();
+        m_stats.frameMs      = (m_span.frameUs / frames) / 1000.f;
+        m_stats.worstFrameMs = m_span.worstUs / 1000.f;
+        m_stats.workMs       = (m_span.workUs / frames) / 1000.f;
+        m_stats.sleepMs      = (m_span.sleepUs / frames) / 1000.f;
+
+        m_span       = Span();
+        m_span.start = m_clock.getElapsedTime();
+    }
+};
+
+#endif // GAMELOOP_HPP
@@ -0,0 +1,208 @@
+#ifndef HUD_HPP
+#define HUD_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include <SFML/Graphics.hpp>
+
+#include "SpriteBatch.hpp"
+
+//////////////////////////////////////////////////////////
+/////// HUD
+// Numeric readouts (scores, counters, fps) drawn from a digit strip :
+// '0'-'9' and '-' of a font are rasterised once into an atlas, each
+// counter owns a few slots of one sprite batch. A counter is an integer ;
+// its quads are laid out again only when the value changes, and no string
+// is ever built. Every counter of a Hud is one draw call.
+// Positions follow sf::Text : y is the top of the line, the baseline is
+// one character size below.
+class Hud : public sf::Drawable
+{
+public:
+    enum align{LEFT, CENTER, RIGHT};
+
+    Hud() :
+        m_atlas(),
+        m_glyphs(),
+        m_characterSize{0},
+        m_counters(),
+        m_batch(),
+        m_layouts{0}
+    {
+
+    }
+
+    Hud(const Hud&) = delete;
+    Hud& operator=(const Hud&) = delete;
+
+    // Rasterises the strip, before any counter is added
+    bool load(const sf::Font& font, unsigned characterSize)
+    {
+        m_characterSize = characterSize;
+
+        const char chars[GLYPHS]{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '-'};
+        std::array<sf::Glyph, GLYPHS> glyphs;
+        for(std::size_t g=0; g<GLYPHS; ++g)
+            glyphs[g] = font.getGlyph(static_cast<sf::Uint32>(chars[g]), characterSize, false);
+
+        // The font page holds every glyph loaded above
+        const sf::Image page{font.getTexture(characterSize).copyToImage()};
+        for(std::size_t g=0; g<GLYPHS; ++g){
+            const sf::IntRect& r = glyphs[g].textureRect;
+            sf::Image image;
+            image.create(static_cast<unsigned>(std::max(r.width, 1)), static_cast<unsigned>(std::max(r.height, 1)),
+                         sf::Color::Transparent);
+            image.copy(page, 0, 0, r);
+            m_atlas.add(std::string(1, chars[g]), image);
+
+            m_glyphs[g].bounds  = glyphs[g].bounds;
+            m_glyphs[g].advance = glyphs[g].advance;
+        }
+        if(!m_atlas.build(1024))
+            return false;
+
+        for(std::size_t g=0; g<GLYPHS; ++g){
+            m_glyphs[g].texRect        = m_atlas.get(std::string(1, chars[g]));
+            m_glyphs[g].texRect.width  = glyphs[g].textureRect.width;
+            m_glyphs[g].texRect.height = glyphs[g].textureRect.height;
+        }
+        m_batch.setTexture(&m_atlas.getTexture());
+        return true;
+    }
+
+    // Returns the counter id ; shows 'value' right away. A value wider than
+    // maxDigits saturates : 9999 (-9999) for 4 digits.
+    std::size_t addCounter(const sf::Vector2f& position, align alignment, unsigned maxDigits,
+                           const sf::Color& color = sf::Color::White, long value = 0)
+    {
+        Counter c;
+        c.position  = position;
+        c.alignment = alignment;
+        c.firstSlot = m_batch.size();
+        c.maxDigits = maxDigits + 1;    // sign
+        c.limit     = saturation(maxDigits);
+        c.color     = color;
+        c.value     = value;
+        m_counters.push_back(c);
+        m_batch.resize(c.firstSlot + c.maxDigits);
+        layout(m_counters.back());
+
+        return m_counters.size() - 1;
+    }
+
+    void set(std::size_t counter, long value)
+    {
+        Counter& c = m_counters[counter];
+        if(c.value == value)
+            return;
+        c.value = value;
+        layout(c);
+    }
+
+    inline void add(std::size_t counter, long delta) { set(counter, m_counters[counter].value + delta); }
+    inline long get(std::size_t counter) const { return m_counters[counter].value; }
+
+    void setPosition(std::size_t counter, const sf::Vector2f& position)
+    {
+        m_counters[counter].position = position;
+        layout(m_counters[counter]);
+    }
+
+    // Height of the digits, from their top to the baseline
+    inline float getDigitHeight() const { return -m_glyphs[0].bounds.top; }
+    // Times a counter was laid out (the rest of the frames cost nothing)
+    inline std::size_t getLayouts() const { return m_layouts; }
+
+private:
+    static const std::size_t GLYPHS = 11;
+    static const std::size_t MINUS  = 10;
+
+    struct Glyph
+    {
+        sf::IntRect   texRect;
+        sf::FloatRect bounds;     // from the pen position on the baseline
+        float         advance;
+    };
+
+    struct Counter
+    {
+        sf::Vector2f position;
+        align        alignment;
+        std::size_t  firstSlot;
+        unsigned     maxDigits;
+        unsigned long limit;    // largest magnitude shown
+        sf::Color    color;
+        long         value;
+    };
+
+    TextureAtlas                m_atlas;
+    std::array<Glyph, GLYPHS>   m_glyphs;
+    unsigned                    m_characterSize;
+    std::vector<Counter>        m_counters;
+    SpriteBatch                 m_batch;
+    std::size_t                 m_layouts;
+
+    // 10^digits - 1, or the whole range when that doesn't fit
+    static unsigned long saturation(unsigned digits)
+    {
+        unsigned long limit{0};
+        for(unsigned d=0; d<digits; ++d){
+            if(limit > (std::numeric_limits<unsigned long>::max() - 9) / 10)
+                return std::numeric_limits<unsigned long>::max();
+            limit = limit * 10 + 9;
+        }
+        return limit;
+    }
+
+    void layout(const Counter& c)
+    {
+        ++m_layouts;
+
+        // Glyphs of the value, most significant first (no string)
+        std::array<std::size_t, 24> glyphs;
+        std::size_t count{0};
+        unsigned long magnitude{c.value < 0 ? 0ul - static_cast<unsigned long>(c.value) : static_cast<unsigned long>(c.value)};
+        magnitude = std::min(magnitude, c.limit);
+        do{
+            glyphs[count++] = magnitude % 10;
+            magnitude /= 10;
+        } while(magnitude > 0 && count < glyphs.size() - 1);
+        if(c.value < 0)
+            glyphs[count++] = MINUS;
+        std::reverse(glyphs.begin(), glyphs.begin() + count);
+
+        float width{0.f};
+        for(std::size_t k=0; k<count; ++k)
+            width += m_glyphs[glyphs[k]].advance;
+
+        float x{c.position.x};
+        if(c.alignment == CENTER)
+            x -= width / 2.f;
+        else if(c.alignment == RIGHT)
+            x -= width;
+        const float baseline{c.position.y + m_characterSize};
+
+        for(std::size_t k=0; k<c.maxDigits; ++k){
+            const std::size_t slot{c.firstSlot + k};
+            if(k >= count){
+                m_batch.hide(slot);
+                continue;
+            }
+            const Glyph& g = m_glyphs[glyphs[k]];
+            m_batch.set(slot, sf::FloatRect{x + g.bounds.left, baseline + g.bounds.top, g.bounds.width, g.bounds.height},
+                        g.texRect, c.color);
+            x += g.advance;
+        }
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const
+    {
+        target.draw(m_batch, states);
+    }
+};
+
+#endif // HUD_HPP
@@ -0,0 +1,116 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstdint>
+
+#if defined(_WIN32)
+    #define MAPPEDFILE_WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #define MAPPEDFILE_POSIX
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+//////////////////////////////////////////////////////////
+/////// MAPPED FILE
+// Read-only view of a whole file. Mapped when the OS allows it, so pages
+// are only read when touched ; otherwise the file is read in memory once.
+class MappedFile
+{
+public:
+    MappedFile() : m_data{nullptr}, m_size{0}, m_mapped{false}, m_buffer() {}
+    explicit MappedFile(const std::string& fileName) : MappedFile() { open(fileName); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& fileName)
+    {
+        close();
+#if defined(MAPPEDFILE_POSIX)
+        const int fd{::open(fileName.c_str(), O_RDONLY)};
+        if(fd >= 0){
+            struct stat st;
+            if(fstat(fd, &st) == 0 && st.st_size > 0){
+                void *p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p != MAP_FAILED){
+                    m_data   = static_cast<const std::uint8_t*>(p);
+                    m_size   = static_cast<std::size_t>(st.st_size);
+                    m_mapped = true;
+                }
+            }
+            ::close(fd);
+            if(m_mapped)
+                return true;
+        }
+#elif defined(MAPPEDFILE_WIN32)
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file != INVALID_HANDLE_VALUE){
+            LARGE_INTEGER size;
+            if(GetFileSizeEx(file, &size) && size.QuadPart > 0){
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if(mapping){
+                    const void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping);
+                    if(p){
+                        m_data   = static_cast<const std::uint8_t*>(p);
+                        m_size   = static_cast<std::size_t>(size.QuadPart);
+                        m_mapped = true;
+                    }
+                }
+            }
+            CloseHandle(file);
+            if(m_mapped)
+                return true;
+        }
+#endif
+        // No mapping : plain read
+        std::ifstream is(fileName, std::ios_base::binary);
+        if(!is)
+            return false;
+        m_buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+    void close()
+    {
+        if(m_mapped){
+#if defined(MAPPEDFILE_POSIX)
+            munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#elif defined(MAPPEDFILE_WIN32)
+            UnmapViewOfFile(m_data);
+#endif
+        }
+        m_data   = nullptr;
+        m_size   = 0;
+        m_mapped = false;
+        m_buffer.clear();
+    }
+
+    inline bool isOpen() const { return m_data != nullptr; }
+    inline bool isMapped() const { return m_mapped; }
+    inline const std::uint8_t* data() const { return m_data; }
+    inline std::size_t size() const { return m_size; }
+
+private:
+    const std::uint8_t       *m_data;
+    std::size_t               m_size;
+    bool                      m_mapped;
+    std::vector<std::uint8_t> m_buffer;
+};
+
+#endif // MAPPEDFILE_HPP
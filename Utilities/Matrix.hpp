@@ -0,0 +1,310 @@
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+
+//////////////////////////////////////////////////////////
+/////// MATRIX
+// Row-major grid on one contiguous, 64-byte aligned block : element (i, j)
+// is data()[i * cols() + j], rows are plain ranges the compiler vectorises.
+// Matrix<bool> is bit-packed (one 64-bit word per 64 cells, each row
+// starting on a new word) and replaces std::vector<bool> grids.
+
+/////////// ALIGNED ALLOCATOR (malloc + manual alignment, C++14 has no aligned new)
+template<typename T, std::size_t Align = 64>
+struct AlignedAllocator
+{
+    typedef T value_type;
+    template<typename U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+    AlignedAllocator() noexcept {}
+    template<typename U> AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        // Raw pointer is kept just before the aligned block
+        void *raw = std::malloc((n * sizeof(T)) + Align + sizeof(void*));
+        if(!raw)
+            throw std::bad_alloc();
+        const std::uintptr_t p{(reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + Align - 1) & ~std::uintptr_t(Align - 1)};
+        reinterpret_cast<void**>(p)[-1] = raw;
+        return reinterpret_cast<T*>(p);
+    }
+
+    void deallocate(T *p, std::size_t) noexcept
+    {
+        if(p)
+            std::free(reinterpret_cast<void**>(p)[-1]);
+    }
+};
+template<typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+template<typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+/////////// ROW VIEW (T may be const)
+template<typename T>
+class MatrixRow
+{
+public:
+    MatrixRow(T *first, std::size_t size) : m_data{first}, m_size{size} {}
+
+    inline T& operator[](std::size_t j) const { return m_data[j]; }
+    inline T* begin() const { return m_data; }
+    inline T* end() const { return m_data + m_size; }
+    inline T* data() const { return m_data; }
+    inline std::size_t size() const { return m_size; }
+
+private:
+    T          *m_data;
+    std::size_t m_size;
+};
+
+/////////// SUB-RECTANGLE VIEW (rows keep the parent stride)
+template<typename T>
+class MatrixView
+{
+public:
+    MatrixView(T *first, std::size_t rows, std::size_t cols, std::size_t stride) :
+        m_data{first}, m_rows{rows}, m_cols{cols}, m_stride{stride} {}
+
+    inline T& operator()(std::size_t i, std::size_t j) const { return m_data[(i * m_stride) + j]; }
+    inline MatrixRow<T> row(std::size_t i) const { return MatrixRow<T>(m_data + (i * m_stride), m_cols); }
+    inline std::size_t rows() const { return m_rows; }
+    inline std::size_t cols() const { return m_cols; }
+
+    template<typename U>
+    void fill(const U& value) const
+    {
+        for(std::size_t i=0; i<m_rows; ++i)
+            std::fill_n(m_data + (i * m_stride), m_cols, value);
+    }
+
+private:
+    T          *m_data;
+    std::size_t m_rows;
+    std::size_t m_cols;
+    std::size_t m_stride;
+};
+
+/////////// MATRIX
+template<typename T>
+class Matrix
+{
+public:
+    typedef std::vector<T, AlignedAllocator<T>>  Storage;
+    typedef typename Storage::iterator           iterator;
+    typedef typename Storage::const_iterator     const_iterator;
+
+    Matrix() : m_rows{0}, m_cols{0}, m_data() {}
+
+    Matrix(std::size_t rows, std::size_t cols, const T& value = T()) :
+        m_rows{rows}, m_cols{cols}, m_data(rows * cols, value) {}
+
+    // Row-major values, exactly rows * cols of them
+    Matrix(std::size_t rows, std::size_t cols, std::initializer_list<T> values) :
+        m_rows{rows}, m_cols{cols}, m_data(values.begin(), values.end())
+    {
+        if(m_data.size() != rows * cols)
+            throw std::invalid_argument("Matrix : wrong number of values");
+    }
+
+    inline std::size_t rows() const { return m_rows; }
+    inline std::size_t cols() const { return m_cols; }
+    inline std::size_t size() const { return m_data.size(); }
+    inline bool empty() const { return m_data.empty(); }
+    // Signed on purpose : neighbours of border cells ask for -1
+    inline bool contains(long i, long j) const
+    {
+        return i >= 0 && j >= 0 && static_cast<std::size_t>(i) < m_rows && static_cast<std::size_t>(j) < m_cols;
+    }
+
+    inline T& operator()(std::size_t i, std::size_t j) { return m_data[(i * m_cols) + j]; }
+    inline const T& operator()(std::size_t i, std::size_t j) const { return m_data[(i * m_cols) + j]; }
+    // Linear index (row-major id)
+    inline T& operator[](std::size_t id) { return m_data[id]; }
+    inline const T& operator[](std::size_t id) const { return m_data[id]; }
+
+    T& at(std::size_t i, std::size_t j)
+    {
+        if(i >= m_rows || j >= m_cols)
+            throw std::out_of_range("Matrix::at");
+        return (*this)(i, j);
+    }
+    const T& at(std::size_t i, std::size_t j) const
+    {
+        if(i >= m_rows || j >= m_cols)
+            throw std::out_of_range("Matrix::at");
+        return (*this)(i, j);
+    }
+
+    inline T* data() { return m_data.data(); }
+    inline const T* data() const { return m_data.data(); }
+    inline iterator begin() { return m_data.begin(); }
+    inline iterator end() { return m_data.end(); }
+    inline const_iterator begin() const { return m_data.begin(); }
+    inline const_iterator end() const { return m_data.end(); }
+
+    inline MatrixRow<T> row(std::size_t i) { return MatrixRow<T>(data() + (i * m_cols), m_cols); }
+    inline MatrixRow<const T> row(std::size_t i) const { return MatrixRow<const T>(data() + (i * m_cols), m_cols); }
+
+    MatrixView<T> sub(std::size_t i, std::size_t j, std::size_t rows, std::size_t cols)
+    {
+        clampView(i, j, rows, cols);
+        return MatrixView<T>(data() + (i * m_cols) + j, rows, cols, m_cols);
+    }
+    MatrixView<const T> sub(std::size_t i, std::size_t j, std::size_t rows, std::size_t cols) const
+    {
+        clampView(i, j, rows, cols);
+        return MatrixView<const T>(data() + (i * m_cols) + j, rows, cols, m_cols);
+    }
+
+    void fill(const T& value) { std::fill(m_data.begin(), m_data.end(), value); }
+
+private:
+    std::size_t m_rows;
+    std::size_t m_cols;
+    Storage     m_data;
+
+    void clampView(std::size_t& i, std::size_t& j, std::size_t& rows, std::size_t& cols) const
+    {
+        i    = std::min(i, m_rows);
+        j    = std::min(j, m_cols);
+        rows = std::min(rows, m_rows - i);
+        cols = std::min(cols, m_cols - j);
+    }
+};
+
+/////////// MATRIX<BOOL> (bit-packed)
+template<>
+class Matrix<bool>
+{
+public:
+    typedef std::uint64_t Word;
+    static const std::size_t WORD_BITS = 64;
+
+    // Proxy for one bit, like std::vector<bool>::reference
+    class reference
+    {
+    public:
+        reference(Word *word, Word mask) : m_word{word}, m_mask{mask} {}
+
+        inline operator bool() const { return (*m_word & m_mask) != 0; }
+        inline reference& operator=(bool value)
+        {
+            *m_word = value ? (*m_word | m_mask) : (*m_word & ~m_mask);
+            return *this;
+        }
+        inline reference& operator=(const reference& other) { return *this = static_cast<bool>(other); }
+        inline void flip() { *m_word ^= m_mask; }
+
+    private:
+        Word *m_word;
+        Word  m_mask;
+    };
+
+    Matrix() : m_rows{0}, m_cols{0}, m_wordsPerRow{0}, m_words() {}
+
+    Matrix(std::size_t rows, std::size_t cols, bool value = false) :
+        m_rows{rows},
+        m_cols{cols},
+        m_wordsPerRow{(cols + WORD_BITS - 1) / WORD_BITS},
+        m_words(rows * m_wordsPerRow, 0)
+    {
+        fill(value);
+    }
+
+    Matrix(std::size_t rows, std::size_t cols, std::initializer_list<bool> values) :
+        Matrix(rows, cols, false)
+    {
+        if(values.size() != rows * cols)
+            throw std::invalid_argument("Matrix<bool> : wrong number of values");
+        std::size_t id{0};
+        for(bool v : values){
+            if(v)
+                set(id / m_cols, id % m_cols, true);
+            ++id;
+        }
+    }
+
+    inline std::size_t rows() const { return m_rows; }
+    inline std::size_t cols() const { return m_cols; }
+    inline std::size_t size() const { return m_rows * m_cols; }
+    inline bool empty() const { return size() == 0; }
+    inline bool contains(long i, long j) const
+    {
+        return i >= 0 && j >= 0 && static_cast<std::size_t>(i) < m_rows && static_cast<std::size_t>(j) < m_cols;
+    }
+
+    inline bool operator()(std::size_t i, std::size_t j) const
+    {
+        return (word(i, j) >> (j % WORD_BITS)) & 1u;
+    }
+    inline reference operator()(std::size_t i, std::size_t j)
+    {
+        return reference(&word(i, j), Word(1) << (j % WORD_BITS));
+    }
+    inline void set(std::size_t i, std::size_t j, bool value) { (*this)(i, j) = value; }
+    inline void flip(std::size_t i, std::size_t j) { word(i, j) ^= Word(1) << (j % WORD_BITS); }
+
+    // Whole words of a row : bit b of word w is column (w * 64) + b, padding bits stay 0
+    inline std::size_t wordsPerRow() const { return m_wordsPerRow; }
+    inline Word* rowWords(std::size_t i) { return m_words.data() + (i * m_wordsPerRow); }
+    inline const Word* rowWords(std::size_t i) const { return m_words.data() + (i * m_wordsPerRow); }
+
+    void fill(bool value)
+    {
+        std::fill(m_words.begin(), m_words.end(), value ? ~Word(0) : Word(0));
+        if(value)
+            clearPadding();
+    }
+
+    // Cells set, a popcount per word
+    std::size_t count() const
+    {
+        std::size_t total{0};
+        for(Word w : m_words)
+            total += popcount(w);
+        return total;
+    }
+
+private:
+    std::size_t                                  m_rows;
+    std::size_t                                  m_cols;
+    std::size_t                                  m_wordsPerRow;
+    std::vector<Word, AlignedAllocator<Word>>    m_words;
+
+    inline Word& word(std::size_t i, std::size_t j) { return m_words[(i * m_wordsPerRow) + (j / WORD_BITS)]; }
+    inline const Word& word(std::size_t i, std::size_t j) const { return m_words[(i * m_wordsPerRow) + (j / WORD_BITS)]; }
+
+    void clearPadding()
+    {
+        const std::size_t used{m_cols % WORD_BITS};
+        if(used == 0)
+            return;
+        const Word mask{(Word(1) << used) - 1};
+        for(std::size_t i=0; i<m_rows; ++i)
+            rowWords(i)[m_wordsPerRow - 1] &= mask;
+    }
+
+    static inline std::size_t popcount(Word w)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(__builtin_popcountll(w));
+#else
+        std::size_t n{0};
+        for(; w; w &= w - 1)
+            ++n;
+        return n;
+#endif
+    }
+};
+
+#endif // MATRIX_HPP
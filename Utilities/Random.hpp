@@ -0,0 +1,166 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+//////////////////////////////////////////////////////////
+/////// RANDOM
+// xoshiro256** : 32 bytes of state, a few shifts and multiplies per 64
+// random bits. Seeded explicitly (same seed, same numbers, on every
+// platform), or per thread from the clock through Random::local().
+namespace Random{
+
+    // splitmix64 : advances 'state' and returns the next value
+    inline std::uint64_t splitmix64(std::uint64_t& state)
+    {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // One splitmix64 step from 'x' : spreads seeds and hashes values
+    inline std::uint64_t mix(std::uint64_t x)
+    {
+        return splitmix64(x);
+    }
+
+    class Generator
+    {
+    public:
+        // Usable with <random> distributions and std::shuffle
+        typedef std::uint64_t result_type;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        // Stream n of a seed : n jumps of 2^128 numbers, so parallel
+        // workers seeded (seed, 0), (seed, 1)... never overlap
+        explicit Generator(std::uint64_t seed = 0, std::uint64_t stream = 0) : m_s{} { this->seed(seed, stream); }
+
+        void seed(std::uint64_t seed, std::uint64_t stream = 0)
+        {
+            for(auto&& s : m_s)
+                s = splitmix64(seed);
+            for(std::uint64_t n=0; n<stream; ++n)
+                jump();
+        }
+
+        inline result_type operator()() { return next(); }
+
+        std::uint64_t next()
+        {
+            const std::uint64_t result{rotl(m_s[1] * 5, 7) * 9};
+            const std::uint64_t t{m_s[1] << 17};
+            m_s[2] ^= m_s[0];
+            m_s[3] ^= m_s[1];
+            m_s[1] ^= m_s[2];
+            m_s[0] ^= m_s[3];
+            m_s[2] ^= t;
+            m_s[3]  = rotl(m_s[3], 45);
+            return result;
+        }
+
+        // [0, bound) without modulo bias (Lemire), bound > 0
+        std::uint32_t below(std::uint32_t bound)
+        {
+            std::uint64_t m{(next() >> 32) * bound};
+            if(static_cast<std::uint32_t>(m) < bound){
+                const std::uint32_t threshold{static_cast<std::uint32_t>(-bound) % bound};
+                while(static_cast<std::uint32_t>(m) < threshold)
+                    m = (next() >> 32) * bound;
+            }
+            return static_cast<std::uint32_t>(m >> 32);
+        }
+
+        // [valmin, valmax], both included
+        int between(int valmin, int valmax)
+        {
+            const std::uint32_t range{static_cast<std::uint32_t>(static_cast<std::int64_t>(valmax) - valmin) + 1u};
+            const std::uint32_t r{range == 0 ? static_cast<std::uint32_t>(next() >> 32) : below(range)};
+            return static_cast<int>(static_cast<std::int64_t>(valmin) + r);
+        }
+
+        // [0, 1)
+        inline float nextFloat() { return (next() >> 40) * (1.f / 16777216.f); }
+        inline double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+        // [valmin, valmax)
+        inline float uniform(float valmin, float valmax) { return valmin + ((valmax - valmin) * nextFloat()); }
+
+        ////////// BULK
+        // Random 64-bit words
+        void fillWords(std::uint64_t *out, std::size_t count)
+        {
+            for(std::size_t i=0; i<count; ++i)
+                out[i] = next();
+        }
+
+        // 0 or 1 per byte : 64 cells for one number
+        void fillCoins(std::uint8_t *out, std::size_t count)
+        {
+            std::size_t i{0};
+            for(; i+64<=count; i+=64){
+                const std::uint64_t bits{next()};
+                for(std::size_t b=0; b<64; ++b)
+                    out[i+b] = static_cast<std::uint8_t>((bits >> b) & 1u);
+            }
+            if(i < count){
+                const std::uint64_t bits{next()};
+                for(std::size_t b=0; i<count; ++i, ++b)
+                    out[i] = static_cast<std::uint8_t>((bits >> b) & 1u);
+            }
+        }
+
+        // [0, bound) each, bound > 0
+        void fillBelow(std::uint32_t *out, std::size_t count, std::uint32_t bound)
+        {
+            for(std::size_t i=0; i<count; ++i)
+                out[i] = below(bound);
+        }
+
+        // Same as 2^128 calls to next()
+        void jump()
+        {
+            static const std::uint64_t JUMP[4]{0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                               0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+            std::uint64_t s[4]{0, 0, 0, 0};
+            for(auto j : JUMP)
+                for(int b=0; b<64; ++b){
+                    if(j & (std::uint64_t(1) << b))
+                        for(int k=0; k<4; ++k)
+                            s[k] ^= m_s[k];
+                    next();
+                }
+            for(int k=0; k<4; ++k)
+                m_s[k] = s[k];
+        }
+
+    private:
+        std::uint64_t m_s[4];
+
+        static inline std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    };
+
+    // Generator of the calling thread : no lock, no sharing. Seeded from
+    // the clock and a thread counter until seeded with seedLocal().
+    inline Generator& local()
+    {
+        static std::atomic<std::uint64_t> threads{0};
+        thread_local Generator generator{mix(static_cast<std::uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count())) ^
+                                         mix(std::hash<std::thread::id>()(std::this_thread::get_id())) ^
+                                         mix(++threads)};
+        return generator;
+    }
+
+    inline void seedLocal(std::uint64_t seed) { local().seed(seed); }
+
+    // From the calling thread's generator
+    inline int between(int valmin, int valmax) { return local().between(valmin, valmax); }
+    inline float uniform(float valmin, float valmax) { return local().uniform(valmin, valmax); }
+}
+
+#endif // RANDOM_HPP
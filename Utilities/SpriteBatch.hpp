@@ -0,0 +1,208 @@
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <SFML/Graphics.hpp>
+
+//////////////////////////////////////////////////////////
+/////// TEXTURE ATLAS
+// Every image of a game packed in one texture (shelves, tallest images
+// first), so sprites from different files can share a draw call.
+// Images are added by name, then build() packs and uploads them once.
+class TextureAtlas
+{
+public:
+    TextureAtlas() : m_entries(), m_texture(), m_error() {}
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    bool add(const std::string& name, const std::string& fileName)
+    {
+        sf::Image image;
+        if(!image.loadFromFile(fileName)){
+            m_error = "can't load " + fileName;
+            return false;
+        }
+        add(name, image);
+        return true;
+    }
+
+    void add(const std::string& name, const sf::Image& image)
+    {
+        m_entries.push_back(Entry{name, image, sf::IntRect{}});
+    }
+
+    // Smallest power of two width (up to maxSize) whose shelves fit
+    bool build(unsigned maxSize = 2048, bool smooth = false)
+    {
+        std::vector<std::size_t> order(m_entries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b){
+            return m_entries[a].image.getSize().y > m_entries[b].image.getSize().y;
+        });
+
+        for(unsigned width=64; width<=maxSize; width*=2){
+            const unsigned height{pack(order, width)};
+            if(height == 0 || height > maxSize)
+                continue;
+
+            sf::Image atlas;
+            atlas.create(width, height, sf::Color::Transparent);
+            for(const auto& e : m_entries)
+                atlas.copy(e.image, static_cast<unsigned>(e.rect.left), static_cast<unsigned>(e.rect.top));
+            if(!m_texture.loadFromImage(atlas)){
+                m_error = "can't create the atlas texture";
+                return false;
+            }
+            m_texture.setSmooth(smooth);
+            return true;
+        }
+
+        m_error = "images don't fit in " + std::to_string(maxSize) + "x" + std::to_string(maxSize);
+        return false;
+    }
+
+    // Texture rect of an image, empty if there is no such name
+    sf::IntRect get(const std::string& name) const
+    {
+        for(const auto& e : m_entries)
+            if(e.name == name)
+                return e.rect;
+        return sf::IntRect{};
+    }
+
+    inline const sf::Texture& getTexture() const { return m_texture; }
+    inline const std::string& getError() const { return m_error; }
+
+private:
+    struct Entry
+    {
+        std::string name;
+        sf::Image   image;
+        sf::IntRect rect;
+    };
+
+    // Images are kept apart so smoothing doesn't bleed between them
+    static const unsigned PADDING = 2;
+
+    std::vector<Entry> m_entries;
+    sf::Texture        m_texture;
+    std::string        m_error;
+
+    // Places the images on shelves 'width' wide, returns the height used (0 : too wide)
+    unsigned pack(const std::vector<std::size_t>& order, unsigned width)
+    {
+        unsigned x{0}, y{0}, shelf{0};
+        for(auto id : order){
+            const sf::Vector2u size{m_entries[id].image.getSize()};
+            if(size.x > width)
+                return 0;
+            if(x + size.x > width){
+                y    += shelf + PADDING;
+                x     = 0;
+                shelf = 0;
+            }
+            m_entries[id].rect = sf::IntRect(x, y, size.x, size.y);
+            x    += size.x + PADDING;
+            shelf = std::max(shelf, size.y);
+        }
+        return y + shelf;
+    }
+};
+
+//////////////////////////////////////////////////////////
+/////// SPRITE BATCH
+// Quads of one texture drawn in one call. Each quad keeps its slot from
+// frame to frame : set() rewrites the four vertices only when the quad
+// changed, hide() collapses it so the other slots never move.
+class SpriteBatch : public sf::Drawable
+{
+public:
+    explicit SpriteBatch(const sf::Texture *texture = nullptr, std::size_t slots = 0) :
+        m_texture{texture},
+        m_vertices(slots * 4),
+        m_updated{0}
+    {
+
+    }
+
+    inline void setTexture(const sf::Texture *texture) { m_texture = texture; }
+
+    // New slots are hidden
+    void resize(std::size_t slots) { m_vertices.resize(slots * 4); }
+    inline std::size_t size() const { return m_vertices.size() / 4; }
+
+    // Axis aligned quad
+    void set(std::size_t slot, const sf::FloatRect& rect, const sf::IntRect& texRect,
+             const sf::Color& color = sf::Color::White)
+    {
+        const sf::Vector2f corners[4]{{rect.left, rect.top}, {rect.left + rect.width, rect.top},
+                                      {rect.left + rect.width, rect.top + rect.height},
+                                      {rect.left, rect.top + rect.height}};
+        write(slot, corners, texRect, color);
+    }
+
+    // Quad of 'size' placed by a transform (sf::Transformable::getTransform())
+    void set(std::size_t slot, const sf::Transform& transform, const sf::Vector2f& size,
+             const sf::IntRect& texRect, const sf::Color& color = sf::Color::White)
+    {
+        const sf::Vector2f corners[4]{transform.transformPoint(sf::Vector2f(0.f, 0.f)),
+                                      transform.transformPoint(sf::Vector2f(size.x, 0.f)),
+                                      transform.transformPoint(size),
+                                      transform.transformPoint(sf::Vector2f(0.f, size.y))};
+        write(slot, corners, texRect, color);
+    }
+
+    void hide(std::size_t slot)
+    {
+        const sf::Vector2f corners[4]{};
+        write(slot, corners, sf::IntRect{}, sf::Color::Transparent);
+    }
+
+    // Quads rewritten since the last call
+    std::size_t takeUpdated()
+    {
+        const std::size_t n{m_updated};
+        m_updated = 0;
+        return n;
+    }
+
+private:
+    const sf::Texture      *m_texture;
+    std::vector<sf::Vertex> m_vertices;
+    std::size_t             m_updated;
+
+    void write(std::size_t slot, const sf::Vector2f (&corners)[4], const sf::IntRect& texRect, const sf::Color& color)
+    {
+        const float u0{static_cast<float>(texRect.left)}, v0{static_cast<float>(texRect.top)};
+        const float u1{u0 + texRect.width}, v1{v0 + texRect.height};
+        const sf::Vector2f uv[4]{{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+
+        sf::Vertex *quad = &m_vertices[slot * 4];
+        bool same{true};
+        for(int k=0; k<4 && same; ++k)
+            same = quad[k].position == corners[k] && quad[k].texCoords == uv[k] && quad[k].color == color;
+        if(same)
+            return;
+
+        for(int k=0; k<4; ++k)
+            quad[k] = sf::Vertex{corners[k], color, uv[k]};
+        ++m_updated;
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const
+    {
+        if(m_vertices.empty())
+            return;
+
+        states.texture = m_texture;
+        target.draw(m_vertices.data(), m_vertices.size(), sf::Quads, states);
+    }
+};
+
+#endif // SPRITEBATCH_HPP
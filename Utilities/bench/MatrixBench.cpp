@@ -0,0 +1,204 @@
+//////////////////////////////////////////////////////////
+/////// MATRIX BENCH
+// Matrix<T> / Matrix<bool> against the layouts the games used before :
+// std::vector<T> indexed by hand, a vector of heap cells (GameOfLife),
+// and std::vector<bool>.
+// Build : g++ -std=c++14 -O2 MatrixBench.cpp -o MatrixBench
+// Usage : MatrixBench [rows cols generations]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+
+#include "../Matrix.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct HeapCell
+{
+    bool alive{false};
+    bool next{false};
+};
+
+// Best of a few runs, in ms per generation
+double timeIt(unsigned generations, const std::function<void()>& step)
+{
+    double best{1e30};
+    for(int run=0; run<3; ++run){
+        const Clock::time_point start{Clock::now()};
+        for(unsigned g=0; g<generations; ++g)
+            step();
+        const double ms{std::chrono::duration<double, std::milli>(Clock::now() - start).count()};
+        best = std::min(best, ms / generations);
+    }
+    return best;
+}
+
+void report(const std::string& name, double ms, std::size_t population, double reference)
+{
+    std::cout << std::left << std::setw(34) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(10) << ms << " ms/gen"
+              << std::setprecision(2) << std::setw(8) << (reference / ms) << "x"
+              << std::setw(12) << population << '\n';
+}
+
+template<typename Get>
+unsigned neighbours(long rows, long cols, long i, long j, Get get)
+{
+    unsigned n{0};
+    for(long a=i-1; a<=i+1; ++a)
+        for(long b=j-1; b<=j+1; ++b)
+            if((a != i || b != j) && a >= 0 && b >= 0 && a < rows && b < cols && get(a, b))
+                ++n;
+    return n;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t rows{argc > 3 ? std::stoul(argv[1]) : 512};
+    const std::size_t cols{argc > 3 ? std::stoul(argv[2]) : 512};
+    const unsigned gens{argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 20};
+    const long R{static_cast<long>(rows)}, C{static_cast<long>(cols)};
+
+    std::mt19937 generator{42};
+    std::vector<std::uint8_t> seed(rows * cols);
+    for(auto& s : seed)
+        s = static_cast<std::uint8_t>(generator() & 1u);
+
+    std::cout << "Life step on " << rows << 'x' << cols << ", best of 3 x " << gens << " generations\n"
+              << std::left << std::setw(34) << "layout" << std::right
+              << std::setw(17) << "time" << std::setw(9) << "speed" << std::setw(12) << "population" << '\n';
+
+    /////// Heap cells, vector of pointers (GameOfLife's Grille)
+    std::vector<std::unique_ptr<HeapCell>> heap;
+    for(auto s : seed){
+        heap.push_back(std::make_unique<HeapCell>());
+        heap.back()->alive = s != 0;
+    }
+    const double refMs{timeIt(gens, [&]{
+        for(long i=0; i<R; ++i)
+            for(long j=0; j<C; ++j){
+                HeapCell& c = *heap[(i*C)+j];
+                const unsigned n{neighbours(R, C, i, j, [&](long a, long b){ return heap[(a*C)+b]->alive; })};
+                c.next = (n == 3) || (n == 2 && c.alive);
+            }
+        for(auto& c : heap)
+            c->alive = c->next;
+    })};
+    std::size_t pop{0};
+    for(const auto& c : heap)
+        pop += c->alive;
+    report("vector<unique_ptr<Cell>> i*cols+j", refMs, pop, refMs);
+
+    /////// std::vector<std::uint8_t>, hand indexing
+    {
+        std::vector<std::uint8_t> curr(seed), next(seed.size());
+        const double ms{timeIt(gens, [&]{
+            for(long i=0; i<R; ++i)
+                for(long j=0; j<C; ++j){
+                    const unsigned n{neighbours(R, C, i, j, [&](long a, long b){ return curr[(a*C)+b] != 0; })};
+                    next[(i*C)+j] = (n == 3) || (n == 2 && curr[(i*C)+j]);
+                }
+            curr.swap(next);
+        })};
+        pop = 0;
+        for(auto c : curr)
+            pop += c;
+        report("vector<uint8_t> i*cols+j", ms, pop, refMs);
+    }
+
+    /////// Matrix<std::uint8_t>, row views (branch-free interior)
+    {
+        Matrix<std::uint8_t> curr(rows, cols, 0), next(rows, cols, 0);
+        std::copy(seed.begin(), seed.end(), curr.begin());
+        const double ms{timeIt(gens, [&]{
+            for(std::size_t i=0; i<rows; ++i){
+                const auto up   = curr.row(i > 0 ? i-1 : i);
+                const auto mid  = curr.row(i);
+                const auto down = curr.row(i+1 < rows ? i+1 : i);
+                const unsigned upOk{i > 0 ? 1u : 0u}, downOk{i+1 < rows ? 1u : 0u};
+                auto out = next.row(i);
+                // Borders with bound checks, the inner columns as a plain loop
+                auto cell = [&](std::size_t j){
+                    const unsigned n{neighbours(R, C, static_cast<long>(i), static_cast<long>(j),
+                                                [&](long a, long b){ return curr(a, b) != 0; })};
+                    out[j] = (n == 3) || (n == 2 && mid[j]);
+                };
+                cell(0);
+                for(std::size_t j=1; j+1<cols; ++j){
+                    const unsigned n = upOk * (up[j-1] + up[j] + up[j+1]) +
+                                       mid[j-1] + mid[j+1] +
+                                       downOk * (down[j-1] + down[j] + down[j+1]);
+                    out[j] = static_cast<std::uint8_t>((n == 3) | ((n == 2) & mid[j]));
+                }
+                if(cols > 1)
+                    cell(cols-1);
+            }
+            std::swap(curr, next);
+        })};
+        pop = 0;
+        for(auto c : curr)
+            pop += c;
+        report("Matrix<uint8_t> row views", ms, pop, refMs);
+    }
+
+    /////// std::vector<bool>
+    {
+        std::vector<bool> curr(seed.begin(), seed.end()), next(seed.size());
+        const double ms{timeIt(gens, [&]{
+            for(long i=0; i<R; ++i)
+                for(long j=0; j<C; ++j){
+                    const unsigned n{neighbours(R, C, i, j, [&](long a, long b){ return static_cast<bool>(curr[(a*C)+b]); })};
+                    next[(i*C)+j] = (n == 3) || (n == 2 && curr[(i*C)+j]);
+                }
+            curr.swap(next);
+        })};
+        pop = 0;
+        for(bool c : curr)
+            pop += c;
+        report("vector<bool> i*cols+j", ms, pop, refMs);
+    }
+
+    /////// Matrix<bool>, per cell access
+    {
+        Matrix<bool> curr(rows, cols), next(rows, cols);
+        for(std::size_t id=0; id<seed.size(); ++id)
+            curr.set(id / cols, id % cols, seed[id] != 0);
+        const double ms{timeIt(gens, [&]{
+            for(long i=0; i<R; ++i)
+                for(long j=0; j<C; ++j){
+                    const unsigned n{neighbours(R, C, i, j, [&](long a, long b){ return curr(a, b); })};
+                    next.set(i, j, (n == 3) || (n == 2 && curr(i, j)));
+                }
+            std::swap(curr, next);
+        })};
+        report("Matrix<bool> per cell", ms, curr.count(), refMs);
+    }
+
+    /////// Population count only : std::vector<bool> vs Matrix<bool>::count
+    {
+        std::vector<bool> vb(seed.begin(), seed.end());
+        Matrix<bool> mb(rows, cols);
+        for(std::size_t id=0; id<seed.size(); ++id)
+            mb.set(id / cols, id % cols, seed[id] != 0);
+
+        std::size_t a{0}, b{0};
+        const double vbMs{timeIt(gens, [&]{ a = static_cast<std::size_t>(std::count(vb.begin(), vb.end(), true)); })};
+        const double mbMs{timeIt(gens, [&]{ b = mb.count(); })};
+        std::cout << "\nPopulation count : vector<bool> " << std::setprecision(4) << vbMs << " ms, Matrix<bool> "
+                  << mbMs << " ms (" << std::setprecision(1) << (vbMs / mbMs) << "x), "
+                  << (a == b ? "same result" : "RESULTS DIFFER") << '\n';
+    }
+
+    return 0;
+}
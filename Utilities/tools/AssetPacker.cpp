@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////
+/////// ASSET PACKER
+// Packs the asset files of a game into the archive its AssetLoader opens.
+// Names are stored as given : run it from the game folder, with the paths
+// the game loads.
+// Build : g++ -std=c++14 -O2 AssetPacker.cpp -o AssetPacker
+// Each game project builds and runs it before the game (ExtraCommands of
+// its .cbp) ; the archives are also committed for builds without it.
+// Usage : AssetPacker <out.pak> <file>...   (or @list : one file per line)
+//   Tetris/       AssetPacker assets.pak assets/img/tiles_set.png assets/img/canva.png assets/img/GO_screen.png assets/fonts/DS-DIGI.TTF
+//   Pong/         AssetPacker assets.pak assets/img/paddle.png assets/img/ball.png assets/img/ball_cracked.png assets/sounds/sound_bounce.wav assets/sounds/sound_crack.wav assets/fonts/OldLondon.ttf
+//   GameOfLife/   AssetPacker assets.pak arial.ttf
+//   BlockBreaker/ AssetPacker assets.pak assets/img/blk-texture.png
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+#include "../AssetArchive.hpp"
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3){
+        std::cout << "Usage : " << argv[0] << " <out.pak> <file>... (or @list)\n";
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    for(int a=2; a<argc; ++a){
+        const std::string arg{argv[a]};
+        if(arg[0] != '@'){
+            files.push_back(arg);
+            continue;
+        }
+        std::ifstream list(arg.substr(1));
+        if(!list){
+            std::cout << "Can't read " << arg.substr(1) << '\n';
+            return 1;
+        }
+        std::string line;
+        while(std::getline(list, line)){
+            if(!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if(!line.empty() && line[0] != '#')
+                files.push_back(line);
+        }
+    }
+
+    std::string error;
+    if(!AssetArchive::write(argv[1], files, error)){
+        std::cout << error << '\n';
+        return 1;
+    }
+
+    // Read it back : the game must see the same bytes
+    AssetArchive archive;
+    if(!archive.open(argv[1])){
+        std::cout << "Written archive doesn't open : " << archive.getError() << '\n';
+        return 1;
+    }
+    const char *kinds[AssetArchive::KIND_MAX]{"raw", "image", "sound", "font"};
+    for(std::size_t i=0; i<files.size(); ++i){
+        std::ifstream is(files[i], std::ios_base::binary);
+        const std::string bytes{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+        const std::size_t id{archive.find(files[i])};
+        if(id == AssetArchive::NONE || archive.getEntry(id).size != bytes.size() ||
+           !std::equal(bytes.begin(), bytes.end(), reinterpret_cast<const char*>(archive.getData(id)))){
+            std::cout << files[i] << " differs after packing\n";
+            return 1;
+        }
+        std::cout << "  " << files[i] << " (" << kinds[archive.getEntry(id).type] << ", " << bytes.size() << " bytes)\n";
+    }
+
+    std::cout << archive.count() << " file(s) in " << archive.fileSize() << " bytes -> " << argv[1] << '\n';
+
+    return 0;
+}